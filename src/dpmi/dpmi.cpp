@@ -19,6 +19,9 @@
 #include <dpmi.h>
 #include <go32.h>
 
+#include <array>
+#include <vector>
+
 namespace dpmi {
 
 namespace details {} // namespace details
@@ -119,4 +122,154 @@ auto physical_memory_mapping::size() const -> std::size_t {
     return m_pimpl->size();
 }
 
+class windowed_mapping::impl {
+public:
+    impl(std::uint32_t phys_addr, std::size_t size, std::size_t window_size)
+    : m_phys_addr{phys_addr}, m_size{size}, m_window_size{window_size} {
+        if (size == 0u || window_size == 0u) {
+            throw error("invalid physical memory window");
+        }
+        m_windows.resize((size + window_size - 1u) / window_size);
+        for (auto& slot : m_slots) {
+            slot.selector = __dpmi_allocate_ldt_descriptors(1);
+            if (slot.selector < 0) {
+                release();
+                throw error("Failed to allocate LDT descriptor");
+            }
+        }
+    }
+
+    ~impl() { release(); }
+
+    impl(const impl&) = delete;
+    impl& operator=(const impl&) = delete;
+    impl(impl&&) = delete;
+    impl& operator=(impl&&) = delete;
+
+    auto map(std::uint32_t offset) -> view {
+        if (offset >= m_size) {
+            throw error("physical memory offset out of range");
+        }
+        const auto window = offset / m_window_size;
+        const auto window_offset = offset % m_window_size;
+        auto& slot = find_slot(window);
+        slot.last_use = ++m_use_counter;
+        return {slot.selector, static_cast<std::uint32_t>(window_offset),
+                m_windows[window].size - window_offset};
+    }
+
+    [[nodiscard]] auto size() const { return m_size; }
+    [[nodiscard]] auto window_size() const { return m_window_size; }
+
+private:
+    static constexpr auto no_window = ~std::size_t{0};
+
+    struct slot_t {
+        int selector{-1};
+        std::size_t window{no_window};
+        unsigned last_use{0};
+    };
+
+    std::uint32_t m_phys_addr;
+    std::size_t m_size;
+    std::size_t m_window_size;
+    unsigned m_use_counter{0};
+    bool m_can_free{true};
+    std::vector<__dpmi_meminfo> m_windows;
+    std::array<slot_t, 2> m_slots{};
+
+    auto find_slot(std::size_t window) -> slot_t& {
+        auto* victim = &m_slots.front();
+        for (auto& slot : m_slots) {
+            if (slot.window == window) {
+                return slot;
+            }
+            if (slot.last_use < victim->last_use) {
+                victim = &slot;
+            }
+        }
+        if (victim->window != no_window) {
+            unmap(victim->window);
+            victim->window = no_window;
+        }
+        const auto& meminfo = linear_window(window);
+        if (__dpmi_set_segment_base_address(victim->selector,
+                                            meminfo.address) != 0 ||
+            __dpmi_set_segment_limit(victim->selector, meminfo.size - 1) !=
+                0) {
+            throw error("failed to move physical memory window");
+        }
+        victim->window = window;
+        return *victim;
+    }
+
+    // A window gets mapped into the linear address space when a selector is
+    // moved to it. If a window is still mapped, because the host can't free
+    // mappings, it's reused and moving the selector is all there is to do.
+    auto linear_window(std::size_t window) -> const __dpmi_meminfo& {
+        auto& meminfo = m_windows[window];
+        if (meminfo.size == 0u) {
+            const auto start = window * m_window_size;
+            auto request = __dpmi_meminfo{};
+            request.address = m_phys_addr + start;
+            request.size = std::min(m_window_size, m_size - start);
+            if (__dpmi_physical_address_mapping(&request) != 0) {
+                throw error("failed to map physical address");
+            }
+            meminfo = request;
+        }
+        return meminfo;
+    }
+
+    // Windows are unmapped once no selector points to them anymore, so only
+    // as many windows as selectors take linear address space. Not every
+    // host implements freeing a mapping (DPMI 0x0801), after the first
+    // failure all windows stay mapped to make sure each one is mapped once.
+    void unmap(std::size_t window) {
+        auto& meminfo = m_windows[window];
+        if (!m_can_free || meminfo.size == 0u) {
+            return;
+        }
+        if (__dpmi_free_physical_address_mapping(&meminfo) == 0) {
+            meminfo.size = 0u;
+        } else {
+            m_can_free = false;
+        }
+    }
+
+    void release() {
+        for (auto& meminfo : m_windows) {
+            if (meminfo.size != 0u &&
+                __dpmi_free_physical_address_mapping(&meminfo) == 0) {
+                meminfo.size = 0u;
+            }
+        }
+        for (auto& slot : m_slots) {
+            if (slot.selector >= 0 &&
+                __dpmi_free_ldt_descriptor(slot.selector) == 0) {
+                slot.selector = -1;
+            }
+        }
+    }
+};
+
+windowed_mapping::windowed_mapping(std::uint32_t phys_addr, std::size_t size,
+                                   std::size_t window_size)
+: m_pimpl(std::make_unique<impl>(phys_addr, size, window_size)) {}
+
+windowed_mapping::~windowed_mapping() = default;
+windowed_mapping::windowed_mapping(windowed_mapping&& other) noexcept = default;
+windowed_mapping& windowed_mapping::operator=(
+    windowed_mapping&& other) noexcept = default;
+
+auto windowed_mapping::map(std::uint32_t offset) -> view {
+    return m_pimpl->map(offset);
+}
+
+auto windowed_mapping::size() const -> std::size_t { return m_pimpl->size(); }
+
+auto windowed_mapping::window_size() const -> std::size_t {
+    return m_pimpl->window_size();
+}
+
 } // namespace dpmi
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <stdexcept>
@@ -111,4 +112,56 @@ private:
     std::unique_ptr<impl> m_pimpl;
 };
 
+// Maps a large physical memory region through a few fixed-size windows
+// instead of one huge mapping. A couple of LDT selectors are recycled in
+// least recently used order, each one points to a mapped window and the
+// window is unmapped when its selector moves on. So only a few windows take
+// linear address space at any time. Hosts which can't free mappings keep
+// every window mapped once used, which costs as much linear address space
+// as the whole region, but never more.
+class windowed_mapping {
+public:
+    static constexpr std::size_t default_window_size = 4u * 1024u * 1024u;
+
+    struct view {
+        int selector;
+        std::uint32_t offset;
+        std::size_t size;
+    };
+
+    windowed_mapping(std::uint32_t phys_addr, std::size_t size,
+                     std::size_t window_size = default_window_size);
+    ~windowed_mapping();
+
+    windowed_mapping(const windowed_mapping&) = delete;
+    windowed_mapping& operator=(const windowed_mapping&) = delete;
+    windowed_mapping(windowed_mapping&&) noexcept;
+    windowed_mapping& operator=(windowed_mapping&&) noexcept;
+
+    // Makes the memory at the given offset accessible and returns the
+    // selector, the offset relative to it and how many bytes can be accessed
+    // through it from there on.
+    [[nodiscard]] auto map(std::uint32_t offset) -> view;
+
+    // Streams a range of the region window by window. The function is called
+    // with a view to a part of the range and the position of this part
+    // relative to the start of the range.
+    template <typename Func>
+    void for_each_chunk(std::uint32_t offset, std::size_t size, Func&& func) {
+        for (auto pos = std::size_t{0}; pos < size;) {
+            auto chunk = map(offset + pos);
+            chunk.size = std::min(chunk.size, size - pos);
+            func(chunk, pos);
+            pos += chunk.size;
+        }
+    }
+
+    [[nodiscard]] auto size() const -> std::size_t;
+    [[nodiscard]] auto window_size() const -> std::size_t;
+
+private:
+    class impl;
+    std::unique_ptr<impl> m_pimpl;
+};
+
 } // namespace dpmi
@@ -16,17 +16,75 @@
 
 #include <cli.hpp>
 #include <dpmi.hpp>
+#include <engine.hpp>
+#include <faultlog.hpp>
 #include <log.hpp>
 #include <vbe.hpp>
 #include <version.h>
 
+#include <chrono>
+#include <ctime>
+#include <optional>
 #include <stdexcept>
 
 namespace {
 
 using error = std::runtime_error;
+using memtest::bits_per_byte;
+using memtest::parse_orders;
 
-constexpr auto bits_per_byte = 8u;
+using std::chrono::steady_clock;
+
+struct test_options {
+    std::vector<memtest::order> orders;
+    std::uint32_t stride;
+    std::uint32_t hold_seconds;
+    std::uint32_t regions;
+    std::uint32_t loops;
+    std::uint32_t duration_seconds;
+    std::uint32_t reads;
+
+    // Any explicit loop count or duration runs unattended, even one loop
+    [[nodiscard]] auto soak() const -> bool {
+        return loops > 0u || duration_seconds > 0u;
+    }
+
+    // Without a duration zero loops means a single one, with a duration it
+    // means to loop until the time is up.
+    [[nodiscard]] auto keep_running(std::uint32_t iteration,
+                                    steady_clock::duration elapsed) const
+        -> bool {
+        if (iteration == 0u) {
+            return true;
+        }
+        if (duration_seconds == 0u) {
+            return iteration < loops;
+        }
+        return elapsed < std::chrono::seconds{duration_seconds} &&
+               (loops == 0u || iteration < loops);
+    }
+};
+
+struct pass_result {
+    const char* name;
+    memtest::report report;
+};
+
+struct iteration_result {
+    std::uint64_t bytes_failed{0};
+    std::uint32_t chips_failed{0};
+    std::uint32_t throughput_kb{0};
+    // Time from the start of the whole test until the first failure
+    std::optional<steady_clock::duration> first_failure;
+};
+
+struct test_result {
+    std::vector<pass_result> passes;
+    std::vector<iteration_result> iterations;
+    std::optional<memtest::fault_stats> retention;
+    const char* write_engine;
+    const char* read_engine;
+};
 
 auto find_best_mode() -> vbe::mode_info_t {
 
@@ -39,66 +97,168 @@ auto find_best_mode() -> vbe::mode_info_t {
     throw error("No suitable VESA mode found.");
 }
 
+template <typename Tester>
+auto run_passes(Tester& tester, const memtest::geometry& geo,
+                const test_options& options, std::uint32_t iteration,
+                test_result& result) -> std::vector<pass_result> {
+    auto passes = std::vector<pass_result>{};
+    if (options.hold_seconds) {
+        // The retention pass runs all patterns region by region
+        const auto hold = std::chrono::seconds{options.hold_seconds};
+        if (!result.retention) {
+            result.retention.emplace(geo);
+        }
+        passes.push_back({"retention",
+                          tester.run_retention(memtest::patterns,
+                                               options.regions, hold,
+                                               *result.retention)});
+        return passes;
+    }
+    for (const auto kind : options.orders) {
+        // Every iteration shuffles the random order differently
+        const auto sweep = tester.make_sweep(kind, options.stride, iteration);
+        passes.push_back(
+            {memtest::to_string(kind), tester.run(sweep, memtest::patterns)});
+    }
+    return passes;
+}
+
 auto test_video_memory(const std::uint16_t mode_id,
-                       const std::uint16_t bus_width,
-                       const std::uint8_t num_chips) {
+                       const memtest::geometry& geo,
+                       const test_options& options) {
 
     const auto fb = vbe::framebuffer{mode_id};
-    const auto size = vbe::get_total_memory_size();
-    const auto bus_width_in_bytes = bus_width / bits_per_byte;
-    const auto bytes_per_chip = bus_width_in_bytes / num_chips;
-
-    auto result = std::vector<bool>(num_chips, true);
-    auto block = std::vector<std::uint8_t>(bus_width_in_bytes * 1024u, 0u);
-
-    const auto test_pass = [&](const auto& generator) {
-        for (auto addr = 0u; addr < size; addr += block.size()) {
-            const auto rest = std::min(size - addr, block.size());
-            for (auto i = 0u; i < rest; i++) {
-                block[i] = generator(i);
-            }
-            fb.write(addr, block.data(), rest);
+    auto tester = memtest::tester{fb, geo, options.reads};
+
+    auto result =
+        test_result{{}, {}, {}, fb.write_engine(), fb.read_engine()};
+    const auto start = steady_clock::now();
+    for (auto iteration = 0u;
+         options.keep_running(iteration, steady_clock::now() - start);
+         iteration++) {
+        const auto iteration_start = steady_clock::now() - start;
+        auto passes = run_passes(tester, geo, options, iteration, result);
+
+        auto total = memtest::report{geo};
+        for (const auto& pass : passes) {
+            total.merge(pass.report);
+        }
+        auto& stats = result.iterations.emplace_back();
+        stats.bytes_failed = total.faults.bytes_failed();
+        for (auto chip = 0u; chip < geo.num_chips; chip++) {
+            stats.chips_failed += total.faults.chip_failed(chip);
         }
-        for (auto addr = 0u; addr < size; addr += block.size()) {
-            const auto rest = std::min(size - addr, block.size());
-            fb.read(addr, block.data(), rest);
-            for (auto i = 0u; i < rest; i++) {
-                if (block[i] != generator(i)) {
-                    result[(i % bus_width_in_bytes) / bytes_per_chip] = false;
-                }
+        stats.throughput_kb = total.throughput_kb();
+        if (total.first_failure) {
+            stats.first_failure = iteration_start + *total.first_failure;
+        }
+
+        if (result.passes.empty()) {
+            result.passes = std::move(passes);
+        } else {
+            for (auto i = 0u; i < passes.size(); i++) {
+                result.passes[i].report.merge(passes[i].report);
             }
         }
-    };
+    }
+    return result;
+}
 
-    test_pass([](std::uint8_t) { return 0x00; });
-    test_pass([](std::uint8_t) { return 0xFF; });
-    test_pass([](std::uint8_t) { return 0xAA; });
-    test_pass([](std::uint8_t) { return 0x55; });
-    test_pass([](std::uint8_t offs) { return offs; });
+void print_iterations(const std::vector<iteration_result>& iterations) {
+    using std::chrono::duration_cast;
+    using std::chrono::seconds;
 
-    return result;
+    log("\n%5s %10s %6s %11s %8s", "Iter", "Bad bytes", "Chips",
+        "First fail", "KB/s");
+    for (auto i = 0u; i < iterations.size(); i++) {
+        const auto& stats = iterations[i];
+        if (stats.first_failure) {
+            const auto at = duration_cast<seconds>(*stats.first_failure);
+            log("%5u %10u %6u %10us %8u", i + 1u, stats.bytes_failed,
+                stats.chips_failed, at.count(), stats.throughput_kb);
+        } else {
+            log("%5u %10u %6u %11s %8u", i + 1u, stats.bytes_failed,
+                stats.chips_failed, "-", stats.throughput_kb);
+        }
+    }
 }
 
-void check_arguments(const std::uint16_t bus_width,
-                     const std::uint8_t num_chips) {
-    if (bus_width < bits_per_byte) {
+void check_arguments(const cli::args_parser& args) {
+    const auto bus_width = args.get<int>("bus");
+    const auto num_chips = args.get<int>("chips");
+    if (bus_width < static_cast<int>(bits_per_byte) || bus_width > 0xFFFF) {
         throw error("Memory bus width has to be at least 8-bit");
     }
-    if (num_chips == 0u) {
+    if (num_chips <= 0 || num_chips > 0xFF) {
         throw error("Invalid number of chips");
     }
-    if (bus_width / num_chips < bits_per_byte) {
+    if (bus_width / num_chips < static_cast<int>(bits_per_byte)) {
         throw error("Cards with less than a byte per chip are not supported");
     }
+    cli::check_non_negative(
+        args, {"stride", "hold", "regions", "loops", "duration", "reads"});
+}
+
+auto describe(const memtest::faultlog_diff::counts& chip) -> const char* {
+    if (chip.added) {
+        return "NEW FAULT";
+    }
+    if (chip.fixed) {
+        return "FIXED";
+    }
+    return chip.persistent ? "STILL BAD" : "OK";
+}
+
+void report_changes(const std::string& path,
+                    const memtest::faultlog_diff& diff) {
+    const auto recorded = static_cast<std::time_t>(diff.timestamp);
+    const auto* time = std::localtime(&recorded);
+    log("\nCompared to %s (recorded %d-%02d-%02d %02d:%02d):", path,
+        time->tm_year + 1900, time->tm_mon + 1, time->tm_mday, time->tm_hour,
+        time->tm_min);
+    if (!diff.same_card) {
+        log("Warning: the previous run was recorded on another card model");
+    }
+    log("Failed pages: %u new, %u fixed, %u persistent", diff.pages.added,
+        diff.pages.fixed, diff.pages.persistent);
+    for (auto i = 0u; i < diff.chips.size(); i++) {
+        log("Chip %d: %s", i, describe(diff.chips[i]));
+    }
+    for (auto i = 0u; i < diff.unstable_chips.size(); i++) {
+        const auto& chip = diff.unstable_chips[i];
+        if (chip.added || chip.fixed || chip.persistent) {
+            log("Chip %d unstable bits: %s", i, describe(chip));
+        }
+    }
 }
 
-void run(const std::uint16_t bus_width, const std::uint8_t num_chips) {
+void run(const cli::args_parser& args) {
+    check_arguments(args);
 
-    check_arguments(bus_width, num_chips);
+    const std::uint16_t bus_width = args.get<int>("bus");
+    const std::uint8_t num_chips = args.get<int>("chips");
+    const auto order_name = args.get<std::string>("order");
+    const std::uint32_t stride = args.get<int>("stride");
+    const std::uint32_t hold_seconds = args.get<int>("hold");
+    const std::uint32_t requested_regions = args.get<int>("regions");
+    const std::uint32_t loops = args.get<int>("loops");
+    const std::uint32_t duration_seconds = args.get<int>("duration");
+    const std::uint32_t reads = args.get<int>("reads");
+    const auto log_path = args.get<std::string>("log");
+    const auto compare_path = args.get<std::string>("compare");
 
     const auto oem_info = vbe::get_oem_info();
     const auto total_memory = vbe::get_total_memory_size();
     const auto mode = find_best_mode();
+    const auto geo = memtest::geometry{total_memory, bus_width, num_chips};
+    const auto regions =
+        memtest::region_count(geo.blocks(), requested_regions);
+    const auto options =
+        test_options{parse_orders(order_name), stride, hold_seconds, regions,
+                     loops, duration_seconds, reads};
+    const auto card = memtest::card_id{oem_info.vendor_name,
+                                       oem_info.product_name,
+                                       oem_info.revision_name};
 
     log("Test Info:");
     log("----------");
@@ -111,13 +271,66 @@ void run(const std::uint16_t bus_width, const std::uint8_t num_chips) {
     log("Number of chips: %d", num_chips);
     log("Test video mode: %#X [%dx%dx%d]", mode.id, mode.width, mode.height,
         mode.bits_per_pixel);
+    if (hold_seconds) {
+        log("Retention test: %d regions, %ds hold time", regions,
+            hold_seconds);
+    } else {
+        log("Sweep order: %s", order_name);
+    }
+
+    if (options.soak()) {
+        if (duration_seconds) {
+            log("Soak test: %us", duration_seconds);
+        } else {
+            log("Soak test: %u loops", loops);
+        }
+    } else {
+        log("\nThe test can take up to several minutes");
+        log("Press [ENTER] to continue");
+        getchar();
+    }
+    const auto test_result = test_video_memory(mode.id, geo, options);
+
+    log("Copy engines: write %s, read %s\n", test_result.write_engine,
+        test_result.read_engine);
+    log("%-12s %10s %10s %8s", "Pass", "Bad bytes", "Unstable", "KB/s");
+    auto faults = memtest::fault_stats{geo};
+    for (const auto& pass : test_result.passes) {
+        log("%-12s %10u %10u %8u", pass.name,
+            pass.report.faults.bytes_failed(),
+            pass.report.faults.bytes_unstable(), pass.report.throughput_kb());
+        faults.merge(pass.report.faults);
+    }
+    if (test_result.retention) {
+        log("Retention failures: %u bytes",
+            test_result.retention->bytes_failed());
+    }
+    if (options.soak()) {
+        print_iterations(test_result.iterations);
+    }
+    log("");
+    for (auto i = 0u; i < num_chips; i++) {
+        log("Chip %d: %s", i,
+            faults.chip_failed(i)     ? "BAD"
+            : faults.chip_unstable(i) ? "UNSTABLE"
+                                      : "OK");
+    }
+    const auto& unstable = faults.unstable_bits();
+    for (auto bit = 0u; bit < unstable.size(); bit++) {
+        if (unstable[bit]) {
+            log("Unstable data line D%u (chip %u): %u times", bit,
+                geo.chip_of_bit(bit), unstable[bit]);
+        }
+    }
 
-    log("\nThe test can take up to several minutes");
-    log("Press [ENTER] to continue");
-    getchar();
-    const auto test_result = test_video_memory(mode.id, bus_width, num_chips);
-    for (auto i = 0u; i < test_result.size(); i++) {
-        log("Chip %d: %s", i, test_result[i] ? "OK" : "BAD");
+    if (!compare_path.empty()) {
+        report_changes(compare_path,
+                       memtest::compare_faultlog(compare_path.c_str(), card,
+                                                 faults));
+    }
+    if (!log_path.empty()) {
+        memtest::write_faultlog(log_path.c_str(), card, faults);
+        log("\nFault log written to %s", log_path);
     }
 }
 
@@ -131,6 +344,21 @@ int main(int argc, const char* argv[]) {
         const auto params = std::vector<cli::param_decl>{
             {"chips", true, 0, "Number of chips on the card"},
             {"bus", true, 0, "Memory bus width in bits"},
+            {"order", false, std::string{"ascending"},
+             "Sweep order: ascending, descending, interleaved, random, all"},
+            {"stride", false, 4, "Row stride of the interleaved order"},
+            {"hold", false, 0,
+             "Hold time in seconds for a retention test instead of sweeps"},
+            {"regions", false, 16, "Number of regions for the retention test"},
+            {"loops", false, 0,
+             "Soak test iterations, 0 for one or unlimited with --duration"},
+            {"duration", false, 0, "Soak test duration in seconds"},
+            {"reads", false, 1,
+             "Read sweeps per pattern to catch unstable bits. After 64K bad "
+             "bytes the rest of a sweep is only read once"},
+            {"log", false, std::string{}, "Write a fault log to this file"},
+            {"compare", false, std::string{},
+             "Compare the results with a previous fault log"},
         };
 
         const auto args = cli::args_parser{argc, argv, params};
@@ -139,7 +367,7 @@ int main(int argc, const char* argv[]) {
             return EXIT_SUCCESS;
         }
 
-        run(args.get<int>("bus"), args.get<int>("chips"));
+        run(args);
         return EXIT_SUCCESS;
     } catch (std::exception& ex) {
         log("error: %s", ex.what());
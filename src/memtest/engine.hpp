@@ -0,0 +1,498 @@
+// Necrowares's Video Memory Tester
+// Copyright (C) 2025 by Necroware
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "order.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+namespace memtest {
+
+constexpr auto bits_per_byte = 8u;
+
+// Describes how the memory under test is organized on the card
+struct geometry {
+    std::size_t size;
+    std::uint16_t bus_width;
+    std::uint8_t num_chips;
+
+    [[nodiscard]] constexpr auto bus_bytes() const -> std::size_t {
+        return bus_width / bits_per_byte;
+    }
+    [[nodiscard]] constexpr auto bytes_per_chip() const -> std::size_t {
+        return bus_bytes() / num_chips;
+    }
+    [[nodiscard]] constexpr auto chip_of_bit(std::size_t bit) const
+        -> std::size_t {
+        return bit / (bytes_per_chip() * bits_per_byte);
+    }
+    // Memory is tested in blocks of 1024 bus words
+    [[nodiscard]] constexpr auto block_size() const -> std::size_t {
+        return bus_bytes() * 1024u;
+    }
+    [[nodiscard]] constexpr auto blocks() const -> std::uint32_t {
+        return (size + block_size() - 1u) / block_size();
+    }
+};
+
+// Tells if any of the data lines belonging to the chip has seen errors
+inline auto chip_failed(const std::vector<std::uint32_t>& bit_errors,
+                        const geometry& geo, std::size_t chip) -> bool {
+    for (auto bit = 0u; bit < bit_errors.size(); bit++) {
+        if (bit_errors[bit] && geo.chip_of_bit(bit) == chip) {
+            return true;
+        }
+    }
+    return false;
+}
+
+using generator = std::uint8_t (*)(std::uint32_t address);
+
+struct pattern {
+    const char* name;
+    generator generate;
+};
+
+inline constexpr pattern patterns[] = {
+    {"zeros", [](std::uint32_t) -> std::uint8_t { return 0x00; }},
+    {"ones", [](std::uint32_t) -> std::uint8_t { return 0xFF; }},
+    {"checker", [](std::uint32_t) -> std::uint8_t { return 0xAA; }},
+    {"inverse checker", [](std::uint32_t) -> std::uint8_t { return 0x55; }},
+    {"address", [](std::uint32_t addr) -> std::uint8_t { return addr; }},
+};
+
+// Which level leaks away depends on the cell, so retention is checked with
+// all bits charged and all bits discharged.
+inline constexpr pattern retention_patterns[] = {
+    {"ones", [](std::uint32_t) -> std::uint8_t { return 0xFF; }},
+    {"zeros", [](std::uint32_t) -> std::uint8_t { return 0x00; }},
+};
+
+// Granularity of the failure bitmap
+constexpr auto page_size = 4096u;
+
+// Collected mismatches, counted per data line of the memory bus, plus a
+// bitmap of the pages containing at least one failed byte. Bits which read
+// back differently between repeated reads are counted separately as
+// unstable, hard failures are bits which are wrong in every read. Only hard
+// failures mark pages.
+class fault_stats {
+public:
+    explicit fault_stats(const geometry& geo)
+    : m_geometry{geo}, m_bit_errors(geo.bus_width, 0u),
+      m_unstable_bits(geo.bus_width, 0u),
+      m_page_bitmap((page_count() + 7u) / 8u, 0u) {}
+
+    void record(std::uint32_t address, std::uint8_t diff) {
+        m_bytes_failed++;
+        mark_page(address);
+        count_bits(m_bit_errors, address, diff);
+    }
+
+    void record_unstable(std::uint32_t address, std::uint8_t flips) {
+        m_bytes_unstable++;
+        count_bits(m_unstable_bits, address, flips);
+    }
+
+    void merge(const fault_stats& other) {
+        m_bytes_failed += other.m_bytes_failed;
+        m_bytes_unstable += other.m_bytes_unstable;
+        for (auto i = 0u; i < m_bit_errors.size(); i++) {
+            m_bit_errors[i] += other.m_bit_errors[i];
+            m_unstable_bits[i] += other.m_unstable_bits[i];
+        }
+        for (auto i = 0u; i < m_page_bitmap.size(); i++) {
+            m_page_bitmap[i] |= other.m_page_bitmap[i];
+        }
+    }
+
+    [[nodiscard]] auto geo() const -> const geometry& { return m_geometry; }
+    [[nodiscard]] auto bytes_failed() const { return m_bytes_failed; }
+    [[nodiscard]] auto bit_errors() const -> const auto& {
+        return m_bit_errors;
+    }
+    [[nodiscard]] auto bytes_unstable() const { return m_bytes_unstable; }
+    [[nodiscard]] auto unstable_bits() const -> const auto& {
+        return m_unstable_bits;
+    }
+    [[nodiscard]] auto page_bitmap() const -> const auto& {
+        return m_page_bitmap;
+    }
+    [[nodiscard]] auto page_count() const -> std::uint32_t {
+        return (m_geometry.size + page_size - 1u) / page_size;
+    }
+
+    [[nodiscard]] auto chip_failed(std::size_t chip) const -> bool {
+        return memtest::chip_failed(m_bit_errors, m_geometry, chip);
+    }
+    [[nodiscard]] auto chip_unstable(std::size_t chip) const -> bool {
+        return memtest::chip_failed(m_unstable_bits, m_geometry, chip);
+    }
+
+private:
+    geometry m_geometry;
+    std::uint64_t m_bytes_failed{0};
+    std::uint64_t m_bytes_unstable{0};
+    std::vector<std::uint32_t> m_bit_errors;
+    std::vector<std::uint32_t> m_unstable_bits;
+    std::vector<std::uint8_t> m_page_bitmap;
+
+    void mark_page(std::uint32_t address) {
+        const auto page = address / page_size;
+        m_page_bitmap[page / 8u] |= 1u << (page % 8u);
+    }
+
+    void count_bits(std::vector<std::uint32_t>& counters,
+                    std::uint32_t address, std::uint8_t bits) const {
+        const auto lane = address % m_geometry.bus_bytes() * bits_per_byte;
+        for (auto bit = 0u; bit < bits_per_byte; bit++) {
+            if (bits & (1u << bit)) {
+                counters[lane + bit]++;
+            }
+        }
+    }
+};
+
+struct report {
+    using clock = std::chrono::steady_clock;
+
+    explicit report(const geometry& geo) : faults{geo} {}
+
+    fault_stats faults;
+    std::uint64_t bytes{0};
+    clock::duration elapsed{};
+    // Time from the start of the run until the first failure was seen
+    std::optional<clock::duration> first_failure;
+
+    void check_failure(clock::time_point start) {
+        if (!first_failure && faults.bytes_failed()) {
+            first_failure = clock::now() - start;
+        }
+    }
+
+    // Appends a later run
+    void merge(const report& other) {
+        faults.merge(other.faults);
+        if (!first_failure && other.first_failure) {
+            first_failure = elapsed + *other.first_failure;
+        }
+        bytes += other.bytes;
+        elapsed += other.elapsed;
+    }
+
+    [[nodiscard]] auto throughput_kb() const -> std::uint32_t {
+        using namespace std::chrono;
+        const auto ms = duration_cast<milliseconds>(elapsed).count();
+        return ms > 0 ? static_cast<std::uint32_t>(bytes * 1000u / 1024u / ms)
+                      : 0u;
+    }
+};
+
+// The retention test splits the memory into regions of whole blocks. All
+// regions have the same size, only the last one may be shorter, so fewer
+// regions than requested can be used when the blocks don't divide evenly.
+constexpr auto region_blocks(std::uint32_t blocks, std::uint32_t requested)
+    -> std::uint32_t {
+    requested = std::clamp(requested, 1u, blocks);
+    return (blocks + requested - 1u) / requested;
+}
+
+constexpr auto region_count(std::uint32_t blocks, std::uint32_t requested)
+    -> std::uint32_t {
+    const auto size = region_blocks(blocks, requested);
+    return (blocks + size - 1u) / size;
+}
+
+// Writes patterns into the memory and verifies them block by block. Memory
+// is anything with write(offset, data, size) and read(offset, data, size),
+// e.g. the frame buffer, or a simulated card on the host. The verification
+// can repeat the read sweep several times to catch marginal bits, which
+// only costs additional read bandwidth. The interleaved order doesn't visit
+// whole blocks but single DRAM rows, so every transfer switches the row.
+template <typename Memory>
+class tester {
+public:
+    tester(const Memory& memory, const geometry& geo, std::uint32_t reads = 1u)
+    : m_memory{memory}, m_geometry{geo}, m_reads{std::max(reads, 1u)},
+      m_block(geo.block_size(), 0u) {
+        if (m_reads > 1u) {
+            m_suspects.reserve(max_suspects);
+            m_next_suspects.reserve(max_suspects);
+        }
+    }
+
+    [[nodiscard]] auto blocks() const -> std::uint32_t {
+        return m_geometry.blocks();
+    }
+
+    // The unit a sweep of the given order visits at once
+    [[nodiscard]] auto unit_size(order kind) const -> std::size_t {
+        return kind == order::interleaved ? m_geometry.bus_bytes() * row_words
+                                          : m_block.size();
+    }
+
+    [[nodiscard]] auto make_sweep(order kind, std::uint32_t stride = 4u,
+                                  std::uint32_t seed = 0u) const -> sweep {
+        const auto unit = unit_size(kind);
+        const auto units = (m_geometry.size + unit - 1u) / unit;
+        return {kind, static_cast<std::uint32_t>(units), stride, seed};
+    }
+
+    void write(const sweep& units, const pattern& pat) {
+        const auto unit = unit_size(units.kind());
+        for (auto pos = 0u; pos < units.size(); pos++) {
+            write_range(units[pos] * unit, unit, pat);
+        }
+    }
+
+    void verify(const sweep& units, const pattern& pat, fault_stats& faults) {
+        const auto unit = unit_size(units.kind());
+        verify_units(
+            units.size(), [&](auto pos) { return units[pos] * unit; }, unit,
+            pat, faults);
+    }
+
+    // Runs a full write and verify sweep for each of the patterns
+    template <typename Patterns>
+    auto run(const sweep& units, const Patterns& pats) -> report {
+        auto result = report{m_geometry};
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& pat : pats) {
+            write(units, pat);
+            verify(units, pat, result.faults);
+            result.check_failure(start);
+            result.bytes += (1u + m_reads) * m_geometry.size;
+        }
+        result.elapsed = std::chrono::steady_clock::now() - start;
+        return result;
+    }
+
+    // Runs the patterns region by region and additionally checks if the
+    // regions keep their data for the given hold time. After a region is
+    // done with the patterns it gets the first retention pattern and ages
+    // while the following regions are tested, once the hold time has passed
+    // it's verified and gets the next retention pattern. Only the last
+    // regions have to be waited for at the end. Retention faults are
+    // recorded in the report and additionally in the given statistics.
+    template <typename Patterns>
+    auto run_retention(const Patterns& pats, std::uint32_t regions,
+                       std::chrono::steady_clock::duration hold,
+                       fault_stats& retention_faults) -> report {
+        using clock = std::chrono::steady_clock;
+        struct pending {
+            std::uint32_t region;
+            std::uint32_t stage;
+            clock::time_point written;
+        };
+
+        const auto region_size = region_blocks(blocks(), regions);
+        regions = region_count(blocks(), regions);
+        const auto for_each_block = [&](std::uint32_t region, auto&& func) {
+            const auto first = region * region_size;
+            const auto last = std::min(first + region_size, blocks());
+            for (auto block = first; block < last; block++) {
+                func(block);
+            }
+        };
+        const auto verify_region = [&](std::uint32_t region,
+                                       const pattern& pat,
+                                       fault_stats& faults) {
+            const auto first = region * region_size;
+            const auto last = std::min(first + region_size, blocks());
+            verify_units(
+                last - first,
+                [&](auto pos) { return address_of(first + pos); },
+                m_block.size(), pat, faults);
+        };
+
+        auto result = report{m_geometry};
+        auto queue = std::deque<pending>{};
+        const auto start = clock::now();
+        const auto age = [&](const pending& entry) {
+            const auto& pat = retention_patterns[entry.stage];
+            auto faults = fault_stats{m_geometry};
+            verify_region(entry.region, pat, faults);
+            retention_faults.merge(faults);
+            result.faults.merge(faults);
+            result.check_failure(start);
+            const auto next = entry.stage + 1u;
+            if (next < std::size(retention_patterns)) {
+                for_each_block(entry.region, [&](auto block) {
+                    write_block(block, retention_patterns[next]);
+                });
+                queue.push_back({entry.region, next, clock::now()});
+            }
+        };
+        const auto service = [&](bool wait) {
+            while (!queue.empty()) {
+                const auto entry = queue.front();
+                while (clock::now() - entry.written < hold) {
+                    if (!wait) {
+                        return;
+                    }
+                }
+                queue.pop_front();
+                age(entry);
+            }
+        };
+
+        for (auto region = 0u; region < regions; region++) {
+            for (const auto& pat : pats) {
+                for_each_block(region,
+                               [&](auto block) { write_block(block, pat); });
+                verify_region(region, pat, result.faults);
+                result.check_failure(start);
+            }
+            for_each_block(region, [&](auto block) {
+                write_block(block, retention_patterns[0]);
+            });
+            queue.push_back({region, 0u, clock::now()});
+            service(false);
+        }
+        service(true);
+        result.elapsed = clock::now() - start;
+        result.bytes = (std::size(pats) + std::size(retention_patterns)) *
+                       (1u + m_reads) * m_geometry.size;
+        return result;
+    }
+
+private:
+    // The smallest row of the DRAMs used on video cards has 256 columns
+    static constexpr auto row_words = 256u;
+
+    // Upper limit for the mismatches tracked between repeated read sweeps,
+    // which keeps both lists together at 1MB, affordable on DOS machines
+    static constexpr auto max_suspects = std::size_t{64u * 1024u};
+
+    // A byte which was wrong in at least one read sweep. The bits that were
+    // wrong in every sweep are hard failures, the others are unstable.
+    struct suspect {
+        std::uint32_t address;
+        std::uint8_t always;
+        std::uint8_t ever;
+    };
+
+    const Memory& m_memory;
+    geometry m_geometry;
+    std::uint32_t m_reads;
+    std::vector<std::uint8_t> m_block;
+    std::vector<suspect> m_suspects;
+    std::vector<suspect> m_next_suspects;
+
+    [[nodiscard]] auto address_of(std::uint32_t block) const
+        -> std::uint32_t {
+        return block * m_block.size();
+    }
+
+    void write_block(std::uint32_t block, const pattern& pat) {
+        write_range(address_of(block), m_block.size(), pat);
+    }
+
+    void write_range(std::uint32_t addr, std::size_t size,
+                     const pattern& pat) {
+        const auto rest = std::min(m_geometry.size - addr, size);
+        for (auto i = 0u; i < rest; i++) {
+            m_block[i] = pat.generate(addr + i);
+        }
+        m_memory.write(addr, m_block.data(), rest);
+    }
+
+    // Reads a unit into the block buffer and returns its length
+    auto read_range(std::uint32_t addr, std::size_t size) -> std::size_t {
+        const auto rest = std::min(m_geometry.size - addr, size);
+        m_memory.read(addr, m_block.data(), rest);
+        return rest;
+    }
+
+    // Verifies the units given by their addresses in visiting order. With
+    // several reads the whole read sweep is repeated, so time and other
+    // traffic pass between two reads of a cell. The mismatching bytes are
+    // kept in visiting order, which lets every further sweep walk them in
+    // lockstep. Once too many bytes mismatch in the first sweep, the rest
+    // of the units is only read once, such a card is broken anyway.
+    template <typename Addresses>
+    void verify_units(std::uint32_t count, Addresses&& address_of_unit,
+                      std::size_t unit, const pattern& pat,
+                      fault_stats& faults) {
+        auto tracked = m_reads > 1u ? count : 0u;
+        m_suspects.clear();
+        for (auto pos = 0u; pos < count; pos++) {
+            if (pos < tracked && m_suspects.size() + unit > max_suspects) {
+                tracked = pos;
+            }
+            const std::uint32_t addr = address_of_unit(pos);
+            const auto rest = read_range(addr, unit);
+            for (auto i = std::uint32_t{0}; i < rest; i++) {
+                const std::uint8_t diff = m_block[i] ^ pat.generate(addr + i);
+                if (!diff) {
+                    continue;
+                }
+                if (pos < tracked) {
+                    m_suspects.push_back({addr + i, diff, diff});
+                } else {
+                    faults.record(addr + i, diff);
+                }
+            }
+        }
+
+        for (auto read = 1u; read < m_reads; read++) {
+            m_next_suspects.clear();
+            auto next = m_suspects.begin();
+            for (auto pos = 0u; pos < tracked; pos++) {
+                const std::uint32_t addr = address_of_unit(pos);
+                const auto rest = read_range(addr, unit);
+                for (auto i = std::uint32_t{0}; i < rest; i++) {
+                    const std::uint8_t diff =
+                        m_block[i] ^ pat.generate(addr + i);
+                    if (next != m_suspects.end() &&
+                        next->address == addr + i) {
+                        next->always &= diff;
+                        next->ever |= diff;
+                        m_next_suspects.push_back(*next++);
+                    } else if (!diff) {
+                        continue;
+                    } else if (m_next_suspects.size() +
+                                   (m_suspects.end() - next) <
+                               max_suspects) {
+                        // Was right in an earlier sweep
+                        m_next_suspects.push_back({addr + i, 0u, diff});
+                    } else {
+                        faults.record_unstable(addr + i, diff);
+                    }
+                }
+            }
+            m_suspects.swap(m_next_suspects);
+        }
+
+        for (const auto& byte : m_suspects) {
+            if (byte.always) {
+                faults.record(byte.address, byte.always);
+            }
+            if (const auto flips = byte.ever & ~byte.always) {
+                faults.record_unstable(byte.address, flips);
+            }
+        }
+    }
+};
+
+} // namespace memtest
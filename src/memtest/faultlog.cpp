@@ -0,0 +1,172 @@
+// Necrowares's Video Memory Tester
+// Copyright (C) 2025 by Necroware
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "faultlog.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <ctime>
+
+namespace memtest {
+
+namespace {
+
+void copy_id(char (&dst)[faultlog_header::id_length], const std::string& src) {
+    std::memset(dst, 0, sizeof(dst));
+    std::memcpy(dst, src.data(), std::min(src.size(), sizeof(dst) - 1u));
+}
+
+auto to_string(const char (&src)[faultlog_header::id_length]) -> std::string {
+    return {src, std::find(src, src + sizeof(src), '\0')};
+}
+
+void add(faultlog_diff::counts& counts, bool before, bool now) {
+    if (before && now) {
+        counts.persistent++;
+    } else if (now) {
+        counts.added++;
+    } else if (before) {
+        counts.fixed++;
+    }
+}
+
+} // namespace
+
+void write_faultlog(const char* path, const card_id& card,
+                    const fault_stats& faults) {
+    const auto& geo = faults.geo();
+    auto header = faultlog_header{};
+    std::memcpy(header.magic, faultlog_header::magic_value,
+                sizeof(header.magic));
+    header.version = faultlog_header::current_version;
+    header.bus_width = geo.bus_width;
+    header.num_chips = geo.num_chips;
+    header.total_memory = geo.size;
+    header.page_size = page_size;
+    header.page_count = faults.page_count();
+    header.bytes_failed = faults.bytes_failed();
+    header.bytes_unstable = faults.bytes_unstable();
+    header.timestamp = static_cast<std::uint32_t>(std::time(nullptr));
+    copy_id(header.vendor, card.vendor);
+    copy_id(header.product, card.product);
+    copy_id(header.revision, card.revision);
+
+    auto* file = std::fopen(path, "wb");
+    if (!file) {
+        throw faultlog_error("can't create " + std::string{path});
+    }
+    const auto write_counters = [file](const std::vector<std::uint32_t>& bits) {
+        return std::fwrite(bits.data(), sizeof(bits[0]), bits.size(), file) ==
+               bits.size();
+    };
+    const auto& bitmap = faults.page_bitmap();
+    const auto ok =
+        std::fwrite(&header, sizeof(header), 1u, file) == 1u &&
+        write_counters(faults.bit_errors()) &&
+        write_counters(faults.unstable_bits()) &&
+        std::fwrite(bitmap.data(), 1u, bitmap.size(), file) == bitmap.size();
+    if (std::fclose(file) != 0 || !ok) {
+        throw faultlog_error("can't write " + std::string{path});
+    }
+}
+
+faultlog_reader::faultlog_reader(const char* path)
+: m_file{std::fopen(path, "rb")} {
+    if (!m_file) {
+        throw faultlog_error("can't open " + std::string{path});
+    }
+    if (std::fread(&m_header, sizeof(m_header), 1u, m_file.get()) != 1u ||
+        std::memcmp(m_header.magic, faultlog_header::magic_value,
+                    sizeof(m_header.magic)) != 0) {
+        throw faultlog_error(std::string{path} + " is not a fault log");
+    }
+    if (m_header.version != faultlog_header::current_version) {
+        throw faultlog_error("unsupported version of " + std::string{path});
+    }
+    const auto read_counters = [&](std::vector<std::uint32_t>& bits) {
+        bits.resize(m_header.bus_width);
+        if (std::fread(bits.data(), sizeof(bits[0]), bits.size(),
+                       m_file.get()) != bits.size()) {
+            throw faultlog_error(std::string{path} + " is truncated");
+        }
+    };
+    read_counters(m_bit_errors);
+    read_counters(m_unstable_bits);
+    m_bitmap_left = (m_header.page_count + 7u) / 8u;
+}
+
+auto faultlog_reader::card() const -> card_id {
+    return {to_string(m_header.vendor), to_string(m_header.product),
+            to_string(m_header.revision)};
+}
+
+auto faultlog_reader::read_bitmap(std::uint8_t* buffer, std::size_t size)
+    -> std::size_t {
+    const auto len = std::min(size, m_bitmap_left);
+    if (std::fread(buffer, 1u, len, m_file.get()) != len) {
+        throw faultlog_error("fault log is truncated");
+    }
+    m_bitmap_left -= len;
+    return len;
+}
+
+auto compare_faultlog(const char* path, const card_id& card,
+                      const fault_stats& faults) -> faultlog_diff {
+    auto reader = faultlog_reader{path};
+    const auto& header = reader.header();
+    const auto& geo = faults.geo();
+    if (header.bus_width != geo.bus_width ||
+        header.num_chips != geo.num_chips ||
+        header.page_size != page_size ||
+        header.page_count != faults.page_count()) {
+        throw faultlog_error(std::string{path} +
+                             " was recorded with a different setup");
+    }
+
+    auto diff = faultlog_diff{};
+    diff.same_card = reader.card() == card;
+    diff.timestamp = header.timestamp;
+
+    const auto& current = faults.page_bitmap();
+    std::uint8_t chunk[512];
+    for (auto pos = std::size_t{0};;) {
+        const auto len = reader.read_bitmap(chunk, sizeof(chunk));
+        if (len == 0u) {
+            break;
+        }
+        for (auto i = 0u; i < len; i++, pos++) {
+            const auto before = chunk[i];
+            const auto now = current[pos];
+            diff.pages.persistent += std::popcount<std::uint8_t>(before & now);
+            diff.pages.added += std::popcount<std::uint8_t>(now & ~before);
+            diff.pages.fixed += std::popcount<std::uint8_t>(before & ~now);
+        }
+    }
+
+    diff.chips.resize(geo.num_chips);
+    diff.unstable_chips.resize(geo.num_chips);
+    for (auto chip = 0u; chip < geo.num_chips; chip++) {
+        add(diff.chips[chip], chip_failed(reader.bit_errors(), geo, chip),
+            faults.chip_failed(chip));
+        add(diff.unstable_chips[chip],
+            chip_failed(reader.unstable_bits(), geo, chip),
+            faults.chip_unstable(chip));
+    }
+    return diff;
+}
+
+} // namespace memtest
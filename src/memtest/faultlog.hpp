@@ -0,0 +1,130 @@
+// Necrowares's Video Memory Tester
+// Copyright (C) 2025 by Necroware
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "engine.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace memtest {
+
+class faultlog_error : public std::runtime_error {
+public:
+    explicit faultlog_error(const std::string& msg)
+    : std::runtime_error{"fault log: " + msg} {}
+};
+
+// Identifies the tested card model, taken from the VBE OEM strings
+struct card_id {
+    std::string vendor;
+    std::string product;
+    std::string revision;
+
+    bool operator==(const card_id&) const = default;
+};
+
+// Fault log file layout, all values little endian:
+//   header
+//   bit error counters, one std::uint32_t per data line of the bus
+//   unstable bit counters, one std::uint32_t per data line of the bus
+//   page failure bitmap of the hard failures, one bit per page, LSB first
+struct __attribute__((packed)) faultlog_header {
+    static constexpr char magic_value[4] = {'N', 'W', 'F', 'L'};
+    static constexpr std::uint16_t current_version = 2u;
+    static constexpr auto id_length = 64u;
+
+    char magic[4];
+    std::uint16_t version;
+    std::uint16_t bus_width;
+    std::uint8_t num_chips;
+    std::uint8_t reserved[3];
+    std::uint32_t total_memory;
+    std::uint32_t page_size;
+    std::uint32_t page_count;
+    std::uint64_t bytes_failed;
+    std::uint64_t bytes_unstable;
+    std::uint32_t timestamp;
+    char vendor[id_length];
+    char product[id_length];
+    char revision[id_length];
+};
+
+// Writes the results of a test run
+void write_faultlog(const char* path, const card_id& card,
+                    const fault_stats& faults);
+
+// Reads a fault log sequentially, the page bitmap is streamed in chunks,
+// so a log never has to be held in memory completely.
+class faultlog_reader {
+public:
+    explicit faultlog_reader(const char* path);
+
+    [[nodiscard]] auto header() const -> const faultlog_header& {
+        return m_header;
+    }
+    [[nodiscard]] auto card() const -> card_id;
+    [[nodiscard]] auto bit_errors() const -> const std::vector<std::uint32_t>& {
+        return m_bit_errors;
+    }
+    [[nodiscard]] auto unstable_bits() const
+        -> const std::vector<std::uint32_t>& {
+        return m_unstable_bits;
+    }
+
+    // Reads the next part of the page bitmap into the buffer and returns
+    // the number of bytes read, zero at the end of the bitmap.
+    auto read_bitmap(std::uint8_t* buffer, std::size_t size) -> std::size_t;
+
+private:
+    struct closer {
+        void operator()(std::FILE* file) const { std::fclose(file); }
+    };
+
+    std::unique_ptr<std::FILE, closer> m_file;
+    faultlog_header m_header{};
+    std::vector<std::uint32_t> m_bit_errors;
+    std::vector<std::uint32_t> m_unstable_bits;
+    std::size_t m_bitmap_left{0};
+};
+
+// Difference between a previous run and the current one. Pages and chips
+// are counted as new when they fail only now, as fixed when they failed
+// only before and as persistent when they fail in both runs. Chips with
+// unstable bits are compared separately from the hard failures.
+struct faultlog_diff {
+    struct counts {
+        std::uint32_t added{0};
+        std::uint32_t fixed{0};
+        std::uint32_t persistent{0};
+    };
+
+    bool same_card{false};
+    std::uint32_t timestamp{0};
+    counts pages;
+    std::vector<counts> chips;
+    std::vector<counts> unstable_chips;
+};
+
+auto compare_faultlog(const char* path, const card_id& card,
+                      const fault_stats& faults) -> faultlog_diff;
+
+} // namespace memtest
@@ -0,0 +1,161 @@
+// Necrowares's Video Memory Tester
+// Copyright (C) 2025 by Necroware
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace memtest {
+
+// The order in which the units of the memory are visited during a sweep.
+// Faults which only show up when the DRAM switches rows or banks are missed
+// by a plain ascending sweep, the other orders provoke such switches.
+enum class order {
+    ascending,
+    descending,
+    interleaved,
+    random,
+};
+
+inline constexpr order all_orders[] = {order::ascending, order::descending,
+                                       order::interleaved, order::random};
+
+constexpr auto to_string(order kind) -> const char* {
+    switch (kind) {
+    case order::ascending:
+        return "ascending";
+    case order::descending:
+        return "descending";
+    case order::interleaved:
+        return "interleaved";
+    case order::random:
+        return "random";
+    }
+    return "unknown";
+}
+
+inline auto parse_order(std::string_view name) -> order {
+    for (const auto kind : all_orders) {
+        if (name == to_string(kind)) {
+            return kind;
+        }
+    }
+    throw std::runtime_error("unknown sweep order");
+}
+
+// Parses a single order or "all" for all of them
+inline auto parse_orders(std::string_view name) -> std::vector<order> {
+    if (name == "all") {
+        return {std::begin(all_orders), std::end(all_orders)};
+    }
+    return {parse_order(name)};
+}
+
+// Maps a position within a sweep to the index of the unit visited at this
+// position. Every order is a permutation computed on the fly, so no table
+// has to be kept in memory. What a unit is, is up to the user of the sweep.
+//
+// - interleaved visits every stride-th unit first, then starts over with
+//   the next one. With DRAM rows as units consecutive accesses always hit
+//   different rows/banks
+// - random is a keyed Feistel network over the next power of four, which
+//   is a bijection, and cycle walking keeps it inside the unit range
+class sweep {
+public:
+    constexpr sweep(order kind, std::uint32_t units, std::uint32_t stride = 4u,
+                    std::uint32_t seed = 0u)
+    : m_kind{kind}, m_units{units}, m_stride{stride ? stride : 1u},
+      m_seed{seed} {
+        while ((std::uint64_t{1} << (2u * m_half_bits)) < m_units) {
+            m_half_bits++;
+        }
+    }
+
+    [[nodiscard]] constexpr auto kind() const { return m_kind; }
+    [[nodiscard]] constexpr auto size() const { return m_units; }
+
+    [[nodiscard]] constexpr auto operator[](std::uint32_t pos) const
+        -> std::uint32_t {
+        switch (m_kind) {
+        case order::descending:
+            return m_units - 1u - pos;
+        case order::interleaved:
+            return interleave(pos);
+        case order::random:
+            return shuffle(pos);
+        default:
+            return pos;
+        }
+    }
+
+private:
+    order m_kind;
+    std::uint32_t m_units;
+    std::uint32_t m_stride;
+    std::uint32_t m_seed;
+    std::uint32_t m_half_bits{0};
+
+    [[nodiscard]] constexpr auto interleave(std::uint32_t pos) const
+        -> std::uint32_t {
+        // The first (units % stride) lanes are one unit longer
+        const auto lane_size = m_units / m_stride;
+        const auto long_lanes = m_units % m_stride;
+        const auto long_part = long_lanes * (lane_size + 1u);
+        if (pos < long_part) {
+            const auto lane = pos / (lane_size + 1u);
+            return lane + (pos % (lane_size + 1u)) * m_stride;
+        }
+        const auto lane = long_lanes + (pos - long_part) / lane_size;
+        return lane + (pos - long_part) % lane_size * m_stride;
+    }
+
+    [[nodiscard]] constexpr auto round(std::uint32_t value,
+                                       std::uint32_t index) const
+        -> std::uint32_t {
+        auto x = value * 0x9E3779B1u + m_seed + index * 0x85EBCA77u;
+        x ^= x >> 15u;
+        x *= 0x2C1B3C6Du;
+        x ^= x >> 12u;
+        return x;
+    }
+
+    [[nodiscard]] constexpr auto feistel(std::uint32_t value) const
+        -> std::uint32_t {
+        const auto mask = (1u << m_half_bits) - 1u;
+        auto left = value >> m_half_bits;
+        auto right = value & mask;
+        for (auto i = 0u; i < 4u; i++) {
+            const auto next = left ^ (round(right, i) & mask);
+            left = right;
+            right = next;
+        }
+        return (left << m_half_bits) | right;
+    }
+
+    [[nodiscard]] constexpr auto shuffle(std::uint32_t pos) const
+        -> std::uint32_t {
+        do {
+            pos = feistel(pos);
+        } while (pos >= m_units);
+        return pos;
+    }
+};
+
+} // namespace memtest
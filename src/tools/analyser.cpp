@@ -0,0 +1,422 @@
+// Necrowares's Video Memory Tester
+// Copyright (C) 2025 by Necroware
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Offline batch analyser. Scans a directory tree of captured tester output
+// and fault logs, groups the tested cards by their VBE OEM strings and
+// aggregates the failure rates per chip position and per data line. A run
+// can be collected twice, as console output and as the fault log written
+// with --log. Console output naming a fault log which sits in the same
+// directory is therefore skipped as duplicate, the log has more details.
+
+#include "percent.hpp"
+#include "work_pool.hpp"
+
+#include <cli.hpp>
+#include <faultlog.hpp>
+#include <log.hpp>
+#include <version.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+using error = std::runtime_error;
+using tools::per_mille;
+
+// Both kinds of input are judged by the same rule as the chip verdicts of
+// the tester: a position with hard failures is bad, one with unstable bits
+// only is unstable.
+enum class verdict { ok, unstable, bad };
+
+auto judge(bool failed, bool unstable) -> verdict {
+    return failed ? verdict::bad : unstable ? verdict::unstable : verdict::ok;
+}
+
+// Counts how many cards were tested on a position and how many of them were
+// bad or unstable there
+struct rate {
+    std::uint32_t tested{0};
+    std::uint32_t failed{0};
+    std::uint32_t unstable{0};
+
+    void add(verdict result) {
+        tested++;
+        failed += result == verdict::bad;
+        unstable += result == verdict::unstable;
+    }
+
+    void merge(const rate& other) {
+        tested += other.tested;
+        failed += other.failed;
+        unstable += other.unstable;
+    }
+};
+
+void add(std::vector<rate>& rates, std::size_t index, verdict result) {
+    if (rates.size() <= index) {
+        rates.resize(index + 1u);
+    }
+    rates[index].add(result);
+}
+
+void merge(std::vector<rate>& rates, const std::vector<rate>& other) {
+    if (rates.size() < other.size()) {
+        rates.resize(other.size());
+    }
+    for (auto i = 0u; i < other.size(); i++) {
+        rates[i].merge(other[i]);
+    }
+}
+
+struct model_stats {
+    rate cards;
+    std::vector<rate> chips;
+    std::vector<rate> data_lines;
+
+    void merge(const model_stats& other) {
+        cards.merge(other.cards);
+        ::merge(chips, other.chips);
+        ::merge(data_lines, other.data_lines);
+    }
+};
+
+struct card_less {
+    bool operator()(const memtest::card_id& a,
+                    const memtest::card_id& b) const {
+        return std::tie(a.vendor, a.product, a.revision) <
+               std::tie(b.vendor, b.product, b.revision);
+    }
+};
+
+struct analysis {
+    std::map<memtest::card_id, model_stats, card_less> models;
+    std::uint32_t files{0};
+    std::uint32_t skipped{0};
+    std::uint32_t duplicates{0};
+
+    void merge(const analysis& other) {
+        for (const auto& [card, stats] : other.models) {
+            models[card].merge(stats);
+        }
+        files += other.files;
+        skipped += other.skipped;
+        duplicates += other.duplicates;
+    }
+};
+
+auto is_faultlog(const fs::path& path) -> bool {
+    char magic[sizeof(memtest::faultlog_header::magic)]{};
+    auto* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    const auto read = std::fread(magic, 1u, sizeof(magic), file);
+    std::fclose(file);
+    return read == sizeof(magic) &&
+           std::memcmp(magic, memtest::faultlog_header::magic_value,
+                       sizeof(magic)) == 0;
+}
+
+// Only the header and the counters are needed, the bitmap isn't touched
+void add_faultlog(const fs::path& path, analysis& result) {
+    const auto reader = memtest::faultlog_reader{path.c_str()};
+    const auto& header = reader.header();
+    const auto geo =
+        memtest::geometry{header.total_memory, header.bus_width,
+                          header.num_chips};
+    if (geo.bus_width < memtest::bits_per_byte || geo.num_chips == 0u ||
+        geo.bytes_per_chip() == 0u) {
+        throw error("invalid geometry");
+    }
+
+    auto& stats = result.models[reader.card()];
+    const auto& bits = reader.bit_errors();
+    const auto& unstable = reader.unstable_bits();
+    stats.cards.add(
+        judge(header.bytes_failed > 0u, header.bytes_unstable > 0u));
+    for (auto chip = 0u; chip < geo.num_chips; chip++) {
+        add(stats.chips, chip,
+            judge(memtest::chip_failed(bits, geo, chip),
+                  memtest::chip_failed(unstable, geo, chip)));
+    }
+    for (auto bit = 0u; bit < bits.size(); bit++) {
+        add(stats.data_lines, bit, judge(bits[bit] > 0u, unstable[bit] > 0u));
+    }
+}
+
+auto value_after(std::string_view line, std::string_view key)
+    -> std::optional<std::string> {
+    if (!line.starts_with(key)) {
+        return std::nullopt;
+    }
+    return std::string{line.substr(key.size())};
+}
+
+// The tester runs on DOS, so the fault log name is matched in the case it
+// was written with and in both plain cases.
+auto has_faultlog_beside(const fs::path& report, std::string_view log_path)
+    -> bool {
+    const auto pos = log_path.find_last_of("\\/:");
+    auto name = std::string{pos == std::string_view::npos
+                                ? log_path
+                                : log_path.substr(pos + 1u)};
+    if (name.empty()) {
+        return false;
+    }
+    auto upper = name;
+    auto lower = name;
+    for (auto i = 0u; i < name.size(); i++) {
+        upper[i] = std::toupper(static_cast<unsigned char>(name[i]));
+        lower[i] = std::tolower(static_cast<unsigned char>(name[i]));
+    }
+    for (const auto& candidate : {name, upper, lower}) {
+        const auto path = report.parent_path() / candidate;
+        auto ec = std::error_code{};
+        if (fs::is_regular_file(path, ec) && is_faultlog(path)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Parses the console output of a tester run line by line. Only the chip
+// verdicts of the test itself count, not the ones of a comparison with a
+// previous run, and reports without any verdict are skipped. Returns false
+// for a duplicate of a fault log.
+auto add_report(const fs::path& path, analysis& result) -> bool {
+    auto* file = std::fopen(path.c_str(), "r");
+    if (!file) {
+        throw error("can't open file");
+    }
+    auto card = memtest::card_id{};
+    auto chips = std::vector<verdict>{};
+    auto log_path = std::string{};
+    auto comparing = false;
+    char buffer[256];
+    while (std::fgets(buffer, sizeof(buffer), file)) {
+        auto line = std::string_view{buffer};
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+            line.remove_suffix(1u);
+        }
+        if (line.starts_with("Compared to ")) {
+            comparing = true;
+        }
+        if (const auto value = value_after(line, "Fault log written to ")) {
+            log_path = *value;
+        } else if (comparing) {
+            continue;
+        } else if (const auto value = value_after(line, "Vendor: ")) {
+            card.vendor = *value;
+        } else if (const auto value = value_after(line, "Product: ")) {
+            card.product = *value;
+        } else if (const auto value = value_after(line, "Revision: ")) {
+            card.revision = *value;
+        } else if (line.starts_with("Chip ")) {
+            auto chip = 0u;
+            char word[16]{};
+            const auto text = std::string{line};
+            if (std::sscanf(text.c_str(), "Chip %u: %15s", &chip, word) ==
+                    2 &&
+                chip < 256u) {
+                if (chips.size() <= chip) {
+                    chips.resize(chip + 1u);
+                }
+                chips[chip] = judge(std::strcmp(word, "BAD") == 0,
+                                    std::strcmp(word, "UNSTABLE") == 0);
+            }
+        }
+    }
+    std::fclose(file);
+    if (chips.empty()) {
+        throw error("no test results");
+    }
+    if (!log_path.empty() && has_faultlog_beside(path, log_path)) {
+        return false;
+    }
+
+    auto& stats = result.models[card];
+    stats.cards.add(*std::max_element(chips.begin(), chips.end()));
+    for (auto chip = 0u; chip < chips.size(); chip++) {
+        add(stats.chips, chip, chips[chip]);
+    }
+    return true;
+}
+
+void add_file(const fs::path& path, analysis& result) {
+    try {
+        if (is_faultlog(path)) {
+            add_faultlog(path, result);
+        } else if (!add_report(path, result)) {
+            result.duplicates++;
+            return;
+        }
+        result.files++;
+    } catch (const std::exception&) {
+        result.skipped++;
+    }
+}
+
+// Hands out the files of a directory tree one by one to the workers, so
+// the file list is never kept in memory. Only the iterators of the open
+// directories are kept. Entries which can't be read are counted and left
+// out instead of aborting the whole scan.
+class file_source {
+public:
+    explicit file_source(const fs::path& root) {
+        m_dirs.emplace_back(root, options);
+    }
+
+    auto next() -> std::optional<fs::path> {
+        const auto lock = std::lock_guard{m_mutex};
+        while (!m_dirs.empty()) {
+            auto& dir = m_dirs.back();
+            if (dir == fs::directory_iterator{}) {
+                m_dirs.pop_back();
+                continue;
+            }
+            const auto entry = *dir;
+            auto ec = std::error_code{};
+            dir.increment(ec);
+            if (ec) {
+                m_errors++;
+                m_dirs.pop_back();
+            }
+            if (entry.is_directory(ec) && !entry.is_symlink(ec)) {
+                auto sub = fs::directory_iterator{entry.path(), options, ec};
+                if (!ec) {
+                    m_dirs.push_back(std::move(sub));
+                    continue;
+                }
+            } else if (entry.is_regular_file(ec)) {
+                return entry.path();
+            }
+            if (ec) {
+                m_errors++;
+            }
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] auto errors() const -> std::uint32_t { return m_errors; }
+
+private:
+    static constexpr auto options =
+        fs::directory_options::skip_permission_denied;
+
+    std::mutex m_mutex;
+    std::vector<fs::directory_iterator> m_dirs;
+    std::uint32_t m_errors{0};
+};
+
+void print_rate(const char* label, std::uint32_t index, const rate& value) {
+    const auto failed = per_mille(value.failed, value.tested);
+    const auto unstable = per_mille(value.unstable, value.tested);
+    log("  %-5s %3u %7u %7u %5u.%u%% %8u %5u.%u%%", label, index, value.tested,
+        value.failed, failed / 10u, failed % 10u, value.unstable,
+        unstable / 10u, unstable % 10u);
+}
+
+void print_results(const analysis& result) {
+    log("Analysed %u files, skipped %u, %u duplicates\n", result.files,
+        result.skipped, result.duplicates);
+    for (const auto& [card, stats] : result.models) {
+        log("%s / %s / %s", card.vendor, card.product, card.revision);
+        log("  Cards: %u, failed: %u, unstable: %u", stats.cards.tested,
+            stats.cards.failed, stats.cards.unstable);
+        log("  %-9s %7s %7s %7s %8s %7s", "Position", "Cards", "Failed", "Rate",
+            "Unstable", "Rate");
+        for (auto chip = 0u; chip < stats.chips.size(); chip++) {
+            print_rate("Chip", chip, stats.chips[chip]);
+        }
+        for (auto bit = 0u; bit < stats.data_lines.size(); bit++) {
+            const auto& line = stats.data_lines[bit];
+            if (line.failed || line.unstable) {
+                print_rate("DQ", bit, stats.data_lines[bit]);
+            }
+        }
+        log("");
+    }
+}
+
+void run(const cli::args_parser& args) {
+    cli::check_non_negative(args, {"threads"});
+
+    const auto root = fs::path{args.get<std::string>("dir")};
+    if (!fs::is_directory(root)) {
+        throw error("not a directory: " + root.string());
+    }
+
+    auto source = file_source{root};
+    const unsigned threads = args.get<int>("threads");
+    auto pool = tools::work_pool{threads};
+    auto partial = std::vector<analysis>(pool.size());
+    for (auto i = 0u; i < pool.size(); i++) {
+        pool.submit([&](unsigned worker) {
+            while (const auto path = source.next()) {
+                add_file(*path, partial[worker]);
+            }
+        });
+    }
+    pool.wait();
+
+    auto total = analysis{};
+    for (const auto& part : partial) {
+        total.merge(part);
+    }
+    total.skipped += source.errors();
+    print_results(total);
+}
+
+} // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        log("Necroware's Video Memory Tester - Report Analyser");
+        log("Version " PROJECT_VERSION " (build date " PROJECT_BUILD_DATE ")\n");
+
+        const auto params = std::vector<cli::param_decl>{
+            {"dir", true, std::string{},
+             "Directory with captured tester output and fault logs"},
+            {"threads", false, 0, "Number of worker threads, 0 for all cores"},
+        };
+
+        const auto args = cli::args_parser{argc, argv, params};
+        if (args.wants_help()) {
+            args.print_usage();
+            return EXIT_SUCCESS;
+        }
+
+        run(args);
+        return EXIT_SUCCESS;
+    } catch (std::exception& ex) {
+        log("error: %s", ex.what());
+        return EXIT_FAILURE;
+    }
+}
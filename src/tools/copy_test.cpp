@@ -0,0 +1,121 @@
+// Necrowares's Video Memory Tester
+// Copyright (C) 2025 by Necroware
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Correctness test of the frame buffer copy engines. Every engine supported
+// by the CPU copies data at all alignments and sizes that exercise the head,
+// bulk and tail paths through the data selector, the results are compared
+// against memcpy. Guard bytes around the target catch overruns. The
+// movedata engine is left out, on the host movedata is a memcpy stand-in,
+// so it would only be compared with itself.
+
+#include <copy.hpp>
+#include <go32.h>
+#include <log.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+constexpr auto max_offset = 32u;
+constexpr auto max_size = 300u;
+constexpr auto guard = 64u;
+constexpr auto buffer_size = guard + max_offset + max_size + guard;
+
+using buffer = std::array<std::uint8_t, buffer_size>;
+
+void fill(buffer& data, std::uint8_t seed) {
+    for (auto i = 0u; i < data.size(); i++) {
+        data[i] = static_cast<std::uint8_t>(i * 7u + seed);
+    }
+}
+
+auto far_offset(const void* ptr) -> std::uint32_t {
+    return static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(ptr));
+}
+
+// The conventional memory side is misaligned independently of the far side
+auto near_position(std::uint32_t offset) -> std::uint32_t {
+    return guard + (offset * 5u) % max_offset;
+}
+
+auto test_write(const vbe::copy::engine& engine, std::uint32_t offset,
+                std::uint32_t size) -> bool {
+    alignas(32) static buffer src, target, expected;
+    fill(src, 0x11u);
+    fill(target, 0x80u);
+    expected = target;
+    const auto pos = guard + offset;
+    const auto* from = src.data() + near_position(offset);
+    std::memcpy(expected.data() + pos, from, size);
+    engine.write(_my_ds(), far_offset(target.data() + pos), from, size);
+    return target == expected;
+}
+
+auto test_read(const vbe::copy::engine& engine, std::uint32_t offset,
+               std::uint32_t size) -> bool {
+    alignas(32) static buffer src, target, expected;
+    fill(src, 0x22u);
+    fill(target, 0x40u);
+    expected = target;
+    const auto pos = near_position(offset);
+    const auto* from = src.data() + guard + offset;
+    std::memcpy(expected.data() + pos, from, size);
+    engine.read(target.data() + pos, _my_ds(), far_offset(from), size);
+    return target == expected;
+}
+
+auto test_engine(const vbe::copy::engine& engine) -> bool {
+    auto failures = 0u;
+    for (auto offset = 0u; offset < max_offset; offset++) {
+        for (auto size = 0u; size <= max_size; size++) {
+            if (!test_write(engine, offset, size)) {
+                log("%s: write of %u bytes at offset %u failed", engine.name,
+                    size, offset);
+                failures++;
+            }
+            if (!test_read(engine, offset, size)) {
+                log("%s: read of %u bytes at offset %u failed", engine.name,
+                    size, offset);
+                failures++;
+            }
+        }
+    }
+    return failures == 0u;
+}
+
+} // namespace
+
+int main() {
+    auto passed = true;
+    for (const auto& engine : vbe::copy::engines()) {
+        if (std::string_view{engine.name} == "movedata") {
+            log("%-8s skipped, only a stand-in on the host", engine.name);
+            continue;
+        }
+        if (!engine.supported()) {
+            log("%-8s not supported by this CPU", engine.name);
+            continue;
+        }
+        const auto ok = test_engine(engine);
+        log("%-8s %s", engine.name, ok ? "OK" : "FAILED");
+        passed = passed && ok;
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
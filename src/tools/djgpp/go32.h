@@ -0,0 +1,27 @@
+// Necrowares's Video Memory Tester
+// Copyright (C) 2025 by Necroware
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Minimal stand-in for the DJGPP header, so the copy engines can be tested
+// natively. Linux runs 32-bit programs on flat segments, so any far pointer
+// made of the data selector and a linear address is a plain pointer.
+
+#pragma once
+
+inline auto _my_ds() -> int {
+    unsigned short selector{};
+    asm("movw %%ds, %0" : "=r"(selector));
+    return selector;
+}
@@ -0,0 +1,28 @@
+// Necrowares's Video Memory Tester
+// Copyright (C) 2025 by Necroware
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Minimal stand-in for the DJGPP header, see go32.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+inline void movedata(unsigned, unsigned src, unsigned, unsigned dst,
+                     std::size_t size) {
+    std::memcpy(reinterpret_cast<void*>(dst),
+                reinterpret_cast<const void*>(src), size);
+}
@@ -0,0 +1,199 @@
+// Necrowares's Video Memory Tester
+// Copyright (C) 2025 by Necroware
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Detection rate regression farm. Runs the pattern and verify engine of the
+// tester against lots of simulated cards with random injected faults and
+// reports how reliably each fault class is detected by each sweep order.
+
+#include "percent.hpp"
+#include "sim_card.hpp"
+#include "work_pool.hpp"
+
+#include <cli.hpp>
+#include <engine.hpp>
+#include <log.hpp>
+#include <version.h>
+
+#include <chrono>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+using error = std::runtime_error;
+using memtest::parse_orders;
+using tools::per_mille;
+
+constexpr auto num_classes = std::size(tools::all_fault_classes);
+constexpr auto num_orders = std::size(memtest::all_orders);
+
+struct settings {
+    memtest::geometry geo;
+    std::vector<memtest::order> orders;
+    std::uint32_t cards{0};
+    std::uint32_t stride{0};
+    std::uint32_t seed{0};
+};
+
+struct outcome {
+    std::uint32_t cards{0};
+    std::uint32_t detected{0};
+    std::uint32_t located{0};
+
+    void merge(const outcome& other) {
+        cards += other.cards;
+        detected += other.detected;
+        located += other.located;
+    }
+};
+
+struct farm_stats {
+    outcome results[num_classes][num_orders]{};
+    std::uint64_t bytes{0};
+
+    void merge(const farm_stats& other) {
+        for (auto i = 0u; i < num_classes; i++) {
+            for (auto j = 0u; j < num_orders; j++) {
+                results[i][j].merge(other.results[i][j]);
+            }
+        }
+        bytes += other.bytes;
+    }
+};
+
+// Every card gets its own random generator seeded by its index, so the
+// results don't depend on how the cards are spread over the workers.
+void test_card(std::uint32_t index, const settings& config, farm_stats& stats) {
+    auto seq = std::seed_seq{config.seed, index};
+    auto rng = std::mt19937{seq};
+    const auto class_index = index % num_classes;
+    const auto kind = tools::all_fault_classes[class_index];
+    const auto injected = tools::fault::random(kind, config.geo, rng);
+    const auto chip = injected.chip(config.geo);
+
+    for (const auto order : config.orders) {
+        const auto card = tools::sim_card{config.geo, injected};
+        auto tester = memtest::tester{card, config.geo};
+        const auto sweep = tester.make_sweep(order, config.stride, rng());
+        const auto report = tester.run(sweep, memtest::patterns);
+
+        auto& result = stats.results[class_index][static_cast<int>(order)];
+        const auto detected = report.faults.bytes_failed() > 0u;
+        result.cards++;
+        result.detected += detected;
+        result.located += chip < 0 ? detected : report.faults.chip_failed(chip);
+        stats.bytes += report.bytes;
+    }
+}
+
+void print_results(const settings& config, const farm_stats& stats,
+                   std::chrono::steady_clock::duration elapsed) {
+    log("%-14s %-12s %7s %9s %9s", "Fault class", "Order", "Cards",
+        "Detected", "Located");
+    for (auto i = 0u; i < num_classes; i++) {
+        for (const auto order : config.orders) {
+            const auto& result = stats.results[i][static_cast<int>(order)];
+            const auto detected = per_mille(result.detected, result.cards);
+            const auto located = per_mille(result.located, result.cards);
+            log("%-14s %-12s %7u %6u.%u%% %6u.%u%%",
+                tools::to_string(tools::all_fault_classes[i]),
+                memtest::to_string(order), result.cards, detected / 10u,
+                detected % 10u, located / 10u, located % 10u);
+        }
+    }
+
+    using namespace std::chrono;
+    const auto ms = std::max<std::uint64_t>(
+        1u, duration_cast<milliseconds>(elapsed).count());
+    log("\nTested %u cards in %u.%03us, %u cards/s, %u MB/s", config.cards,
+        ms / 1000u, ms % 1000u, config.cards * 1000u / ms,
+        stats.bytes * 1000u / ms / (1024u * 1024u));
+}
+
+void run(const cli::args_parser& args) {
+    cli::check_non_negative(args, {"cards", "size", "bus", "chips", "stride",
+                                   "threads", "seed"});
+    if (args.get<int>("bus") > 0xFFFF || args.get<int>("chips") > 0xFF) {
+        throw error("invalid card geometry");
+    }
+
+    const std::uint16_t bus_width = args.get<int>("bus");
+    const std::uint8_t num_chips = args.get<int>("chips");
+    const auto size = static_cast<std::size_t>(args.get<int>("size")) * 1024u;
+    if (bus_width < memtest::bits_per_byte || num_chips == 0u ||
+        bus_width / num_chips < memtest::bits_per_byte || size == 0u) {
+        throw error("invalid card geometry");
+    }
+
+    auto config = settings{{size, bus_width, num_chips},
+                           parse_orders(args.get<std::string>("order"))};
+    config.cards = args.get<int>("cards");
+    config.stride = args.get<int>("stride");
+    config.seed = args.get<int>("seed");
+
+    const auto start = std::chrono::steady_clock::now();
+    const unsigned threads = args.get<int>("threads");
+    auto pool = tools::work_pool{threads};
+    auto stats = std::vector<farm_stats>(pool.size());
+    log("Testing %u cards of %uKB on %u threads\n", config.cards, size / 1024u,
+        pool.size());
+    for (auto i = 0u; i < config.cards; i++) {
+        pool.submit([&, i](unsigned worker) {
+            test_card(i, config, stats[worker]);
+        });
+    }
+    pool.wait();
+
+    auto total = farm_stats{};
+    for (const auto& worker : stats) {
+        total.merge(worker);
+    }
+    print_results(config, total, std::chrono::steady_clock::now() - start);
+}
+
+} // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        log("Necroware's Video Memory Tester - Detection Farm");
+        log("Version " PROJECT_VERSION " (build date " PROJECT_BUILD_DATE ")\n");
+
+        const auto params = std::vector<cli::param_decl>{
+            {"cards", false, 1000, "Number of simulated cards"},
+            {"size", false, 256, "Memory size of a card in KB"},
+            {"bus", false, 64, "Memory bus width in bits"},
+            {"chips", false, 4, "Number of chips on a card"},
+            {"order", false, std::string{"all"},
+             "Sweep order: ascending, descending, interleaved, random, all"},
+            {"stride", false, 4, "Row stride of the interleaved order"},
+            {"threads", false, 0, "Number of worker threads, 0 for all cores"},
+            {"seed", false, 1, "Seed for the fault injection"},
+        };
+
+        const auto args = cli::args_parser{argc, argv, params};
+        if (args.wants_help()) {
+            args.print_usage();
+            return EXIT_SUCCESS;
+        }
+
+        run(args);
+        return EXIT_SUCCESS;
+    } catch (std::exception& ex) {
+        log("error: %s", ex.what());
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,194 @@
+// Necrowares's Video Memory Tester
+// Copyright (C) 2025 by Necroware
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <engine.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace tools {
+
+enum class fault_class {
+    stuck_bit,
+    coupled_cells,
+    dead_lane,
+    address_alias,
+};
+
+inline constexpr fault_class all_fault_classes[] = {
+    fault_class::stuck_bit, fault_class::coupled_cells,
+    fault_class::dead_lane, fault_class::address_alias};
+
+constexpr auto to_string(fault_class kind) -> const char* {
+    switch (kind) {
+    case fault_class::stuck_bit:
+        return "stuck bit";
+    case fault_class::coupled_cells:
+        return "coupled cells";
+    case fault_class::dead_lane:
+        return "dead lane";
+    case fault_class::address_alias:
+        return "address alias";
+    }
+    return "unknown";
+}
+
+// A single injected fault, the meaning of the fields depends on the class:
+// - stuck bit: bit of the byte at address always reads as value
+// - coupled cells: every change of aggressor_bit at the aggressor address
+//   flips bit at address
+// - dead lane: data line bit of the bus always reads as value
+// - address alias: address line bit is stuck at zero
+struct fault {
+    fault_class kind;
+    std::uint32_t address;
+    std::uint32_t aggressor;
+    std::uint8_t bit;
+    std::uint8_t aggressor_bit;
+    bool value;
+
+    static auto random(fault_class kind, const memtest::geometry& geo,
+                       std::mt19937& rng) -> fault {
+        const auto pick = [&](std::uint32_t limit) {
+            return std::uniform_int_distribution<std::uint32_t>{
+                0u, limit - 1u}(rng);
+        };
+        auto address_bits = 0u;
+        while ((std::size_t{1} << (address_bits + 1u)) <= geo.size) {
+            address_bits++;
+        }
+        auto result = fault{kind, pick(geo.size), pick(geo.size), 0u, 0u,
+                            pick(2u) != 0u};
+        switch (kind) {
+        case fault_class::dead_lane:
+            result.bit = pick(geo.bus_width);
+            break;
+        case fault_class::address_alias:
+            result.bit = pick(address_bits);
+            break;
+        default:
+            result.bit = pick(memtest::bits_per_byte);
+            result.aggressor_bit = pick(memtest::bits_per_byte);
+            break;
+        }
+        return result;
+    }
+
+    // The chip which should be reported as bad, or -1 if the fault isn't
+    // bound to a chip
+    [[nodiscard]] auto chip(const memtest::geometry& geo) const -> int {
+        switch (kind) {
+        case fault_class::dead_lane:
+            return geo.chip_of_bit(bit);
+        case fault_class::address_alias:
+            return -1;
+        default:
+            return geo.chip_of_bit(address % geo.bus_bytes() *
+                                       memtest::bits_per_byte +
+                                   bit);
+        }
+    }
+};
+
+// Video memory simulated in host RAM with one injected fault. It provides
+// the same interface as the frame buffer, so the tester runs unchanged.
+class sim_card {
+public:
+    sim_card(const memtest::geometry& geo, const fault& injected)
+    : m_geometry{geo}, m_fault{injected}, m_cells(geo.size, 0u) {}
+
+    void write(std::uint32_t offset, const void* data,
+               std::size_t size) const {
+        const auto* src = static_cast<const std::uint8_t*>(data);
+        if (m_fault.kind == fault_class::address_alias) {
+            for (auto i = 0u; i < size; i++) {
+                m_cells[alias(offset + i)] = src[i];
+            }
+            return;
+        }
+        if (m_fault.kind == fault_class::coupled_cells &&
+            m_fault.aggressor >= offset && m_fault.aggressor - offset < size) {
+            // Copy in two parts, so the victim sees the aggressor change
+            // at the right moment
+            const auto split = m_fault.aggressor - offset;
+            std::memcpy(&m_cells[offset], src, split);
+            const auto before = m_cells[m_fault.aggressor];
+            m_cells[m_fault.aggressor] = src[split];
+            if ((before ^ src[split]) & (1u << m_fault.aggressor_bit)) {
+                m_cells[m_fault.address] ^= 1u << m_fault.bit;
+            }
+            std::memcpy(&m_cells[offset + split + 1u], src + split + 1u,
+                        size - split - 1u);
+            return;
+        }
+        std::memcpy(&m_cells[offset], src, size);
+    }
+
+    void read(std::uint32_t offset, void* data, std::size_t size) const {
+        auto* dst = static_cast<std::uint8_t*>(data);
+        switch (m_fault.kind) {
+        case fault_class::address_alias:
+            for (auto i = 0u; i < size; i++) {
+                dst[i] = m_cells[alias(offset + i)];
+            }
+            break;
+        case fault_class::stuck_bit:
+            std::memcpy(dst, &m_cells[offset], size);
+            if (m_fault.address >= offset && m_fault.address - offset < size) {
+                force(dst[m_fault.address - offset], m_fault.bit);
+            }
+            break;
+        case fault_class::dead_lane: {
+            std::memcpy(dst, &m_cells[offset], size);
+            const auto bus_bytes = m_geometry.bus_bytes();
+            const auto lane = m_fault.bit / memtest::bits_per_byte;
+            const auto bit = m_fault.bit % memtest::bits_per_byte;
+            const auto first =
+                (lane + bus_bytes - offset % bus_bytes) % bus_bytes;
+            for (auto i = first; i < size; i += bus_bytes) {
+                force(dst[i], bit);
+            }
+            break;
+        }
+        default:
+            std::memcpy(dst, &m_cells[offset], size);
+            break;
+        }
+    }
+
+private:
+    memtest::geometry m_geometry;
+    fault m_fault;
+    mutable std::vector<std::uint8_t> m_cells;
+
+    [[nodiscard]] auto alias(std::uint32_t address) const -> std::uint32_t {
+        return address & ~(1u << m_fault.bit);
+    }
+
+    void force(std::uint8_t& byte, unsigned bit) const {
+        if (m_fault.value) {
+            byte |= 1u << bit;
+        } else {
+            byte &= ~(1u << bit);
+        }
+    }
+};
+
+} // namespace tools
@@ -0,0 +1,149 @@
+// Necrowares's Video Memory Tester
+// Copyright (C) 2025 by Necroware
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tools {
+
+// A work stealing thread pool. Every worker has its own task queue and
+// takes new work from the back of it, an idle worker steals from the front
+// of the other queues. Tasks get the index of the executing worker, so they
+// can accumulate results per worker without any locking.
+class work_pool {
+public:
+    using task = std::function<void(unsigned worker)>;
+
+    explicit work_pool(unsigned threads = 0u) {
+        if (threads == 0u) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (auto i = 0u; i < threads; i++) {
+            m_queues.push_back(std::make_unique<queue>());
+        }
+        for (auto i = 0u; i < threads; i++) {
+            m_threads.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    ~work_pool() {
+        wait();
+        {
+            const auto lock = std::lock_guard{m_mutex};
+            m_stop = true;
+        }
+        m_wakeup.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    work_pool(const work_pool&) = delete;
+    work_pool& operator=(const work_pool&) = delete;
+    work_pool(work_pool&&) = delete;
+    work_pool& operator=(work_pool&&) = delete;
+
+    [[nodiscard]] auto size() const -> unsigned { return m_threads.size(); }
+
+    void submit(task func) {
+        m_pending++;
+        auto& target = *m_queues[m_next++ % m_queues.size()];
+        {
+            const auto lock = std::lock_guard{target.mutex};
+            target.tasks.push_back(std::move(func));
+        }
+        {
+            const auto lock = std::lock_guard{m_mutex};
+            m_queued++;
+        }
+        m_wakeup.notify_one();
+    }
+
+    // Blocks until all submitted tasks are done
+    void wait() {
+        auto lock = std::unique_lock{m_mutex};
+        m_done.wait(lock, [this] { return m_pending == 0u; });
+    }
+
+private:
+    struct queue {
+        std::mutex mutex;
+        std::deque<task> tasks;
+    };
+
+    std::vector<std::unique_ptr<queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::condition_variable m_done;
+    std::atomic<std::size_t> m_pending{0};
+    std::size_t m_queued{0};
+    std::atomic<unsigned> m_next{0};
+    bool m_stop{false};
+
+    auto take(unsigned index, task& func) -> bool {
+        for (auto i = 0u; i < m_queues.size(); i++) {
+            auto& source = *m_queues[(index + i) % m_queues.size()];
+            const auto lock = std::lock_guard{source.mutex};
+            if (source.tasks.empty()) {
+                continue;
+            }
+            if (i == 0u) {
+                func = std::move(source.tasks.back());
+                source.tasks.pop_back();
+            } else {
+                func = std::move(source.tasks.front());
+                source.tasks.pop_front();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void work(unsigned index) {
+        for (;;) {
+            {
+                auto lock = std::unique_lock{m_mutex};
+                m_wakeup.wait(lock, [this] { return m_stop || m_queued; });
+                if (m_queued == 0u) {
+                    return;
+                }
+                m_queued--;
+            }
+            // A task is reserved for this worker, but it may sit in any queue
+            auto func = task{};
+            while (!take(index, func)) {
+                std::this_thread::yield();
+            }
+            func(index);
+            if (--m_pending == 0u) {
+                const auto lock = std::lock_guard{m_mutex};
+                m_done.notify_all();
+            }
+        }
+    }
+};
+
+} // namespace tools
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <initializer_list>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -26,7 +27,7 @@ namespace cli {
 
 using error = std::runtime_error;
 
-using value_variant = std::variant<bool, int, std::string, double>;
+using value_variant = std::variant<bool, int, std::string>;
 
 struct param_decl {
     std::string name;
@@ -92,7 +93,6 @@ public:
             std::visit(dispatch{
                            [&msg](bool) {},
                            [&msg](int) { msg += "=<int>"; },
-                           [&msg](double) { msg += "=<float>"; },
                            [&msg](const std::string&) { msg += "=<string>"; },
                        },
                        decl.default_value);
@@ -103,7 +103,7 @@ public:
                     dispatch{
                         [&](const std::string& val) { msg += val; },
                         [&](bool val) { msg += val ? "true" : "false"; }, 
-                        [&](const auto& val) { msg += std::to_string(val); },
+                        [&](int val) { msg += std::to_string(val); },
                     },
                     decl.default_value);
                 msg += ")\n";
@@ -125,7 +125,6 @@ private:
             return std::visit(
                 dispatch{
                     [&](int) -> value_variant { return std::stoi(str); },
-                    [&](double) -> value_variant { return std::stod(str); },
                     [&](const std::string&) -> value_variant { return str; },
                 },
                 decl.default_value);
@@ -165,5 +164,16 @@ private:
     }
 };
 
+// Counts and sizes are given as int options, but used as unsigned values,
+// so a negative value has to be rejected before it turns into a huge one.
+inline void check_non_negative(const args_parser& args,
+                               std::initializer_list<const char*> names) {
+    for (const auto* name : names) {
+        if (args.get<int>(name) < 0) {
+            throw error(std::string{"Negative value for --"} + name);
+        }
+    }
+}
+
 } // namespace cli
 
@@ -16,23 +16,280 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdio>
-#include <string>
+#include <string_view>
+#include <type_traits>
+
+// A small printf-like formatter. The format string is validated against the
+// argument types at compile time, so a wrong conversion or a wrong number of
+// arguments doesn't compile. Supported conversions are %d, %u, %x, %X for any
+// integral type, %c for characters and %s for anything convertible to a
+// string view, each optionally with the flags '-', '0', '#' and a width.
+// The output is collected in a fixed buffer on the stack and written out in
+// one go, longer lines are truncated.
 
 namespace log_internal {
 
+enum class arg_kind { integer, character, string, unsupported };
+
 template <typename T>
-auto wrap_arg(T&& arg) {
-    return std::forward<T>(arg);
+constexpr auto kind_of() -> arg_kind {
+    using type = std::remove_cvref_t<T>;
+    if constexpr (std::is_same_v<type, bool>) {
+        return arg_kind::unsupported;
+    } else if constexpr (std::is_same_v<type, char>) {
+        return arg_kind::character;
+    } else if constexpr (std::is_integral_v<type>) {
+        return arg_kind::integer;
+    } else if constexpr (std::is_convertible_v<const type&, std::string_view>) {
+        return arg_kind::string;
+    } else {
+        return arg_kind::unsupported;
+    }
 }
 
-inline const char* wrap_arg(const std::string& s) { return s.c_str(); }
+struct spec_t {
+    bool left{false};
+    bool zero{false};
+    bool alt{false};
+    std::size_t width{0};
+    char conversion{0};
+};
 
-} // namespace log_internal
+// Parses a conversion specification right after the '%' and moves the
+// position behind it. Returns an empty conversion on a malformed spec.
+constexpr auto parse_spec(std::string_view fmt, std::size_t& pos) -> spec_t {
+    auto spec = spec_t{};
+    for (; pos < fmt.size(); pos++) {
+        if (fmt[pos] == '-') {
+            spec.left = true;
+        } else if (fmt[pos] == '0') {
+            spec.zero = true;
+        } else if (fmt[pos] == '#') {
+            spec.alt = true;
+        } else {
+            break;
+        }
+    }
+    for (; pos < fmt.size() && fmt[pos] >= '0' && fmt[pos] <= '9'; pos++) {
+        spec.width = spec.width * 10u + (fmt[pos] - '0');
+    }
+    if (pos < fmt.size()) {
+        spec.conversion = fmt[pos++];
+    }
+    return spec;
+}
+
+constexpr auto accepts(char conversion, arg_kind kind) -> bool {
+    switch (conversion) {
+    case 'd':
+    case 'u':
+    case 'x':
+    case 'X':
+        return kind == arg_kind::integer || kind == arg_kind::character;
+    case 'c':
+        return kind == arg_kind::character;
+    case 's':
+        return kind == arg_kind::string;
+    default:
+        return false;
+    }
+}
+
+// Not constexpr on purpose, calling it during constant evaluation stops the
+// compilation and points at the faulty format string.
+inline void format_error(const char*) {}
 
 template <typename... Args>
-void log(const char* fmt, Args&&... args) {
-    std::printf(fmt, log_internal::wrap_arg(std::forward<Args>(args))...);
-    std::puts("");
+consteval void check_format(std::string_view fmt) {
+    constexpr arg_kind kinds[] = {kind_of<Args>()..., arg_kind::unsupported};
+    auto index = std::size_t{0};
+    for (auto pos = std::size_t{0}; pos < fmt.size();) {
+        if (fmt[pos++] != '%') {
+            continue;
+        }
+        if (pos < fmt.size() && fmt[pos] == '%') {
+            pos++;
+            continue;
+        }
+        const auto spec = parse_spec(fmt, pos);
+        if (index >= sizeof...(Args)) {
+            format_error("not enough arguments for the format string");
+        } else if (!accepts(spec.conversion, kinds[index])) {
+            format_error("conversion doesn't match the argument type");
+        }
+        index++;
+    }
+    if (index < sizeof...(Args)) {
+        format_error("too many arguments for the format string");
+    }
 }
 
+template <typename... Args>
+class format_string {
+public:
+    template <typename T>
+        requires std::is_convertible_v<const T&, std::string_view>
+    consteval format_string(const T& fmt) : m_fmt{fmt} {
+        check_format<Args...>(m_fmt);
+    }
+
+    [[nodiscard]] constexpr auto get() const -> std::string_view {
+        return m_fmt;
+    }
+
+private:
+    std::string_view m_fmt;
+};
+
+struct arg_t {
+    arg_kind kind{arg_kind::unsupported};
+    bool negative{false};
+    unsigned long long magnitude{0};
+    unsigned long long bits{0};
+    std::string_view str{};
+};
+
+template <typename T>
+auto make_arg(const T& value) -> arg_t {
+    constexpr auto kind = kind_of<T>();
+    auto arg = arg_t{kind};
+    if constexpr (kind == arg_kind::string) {
+        arg.str = value;
+    } else if constexpr (kind != arg_kind::unsupported) {
+        using type = std::remove_cvref_t<T>;
+        using unsigned_type = std::make_unsigned_t<type>;
+        arg.bits = static_cast<unsigned_type>(value);
+        arg.magnitude = arg.bits;
+        if constexpr (std::is_signed_v<type>) {
+            if (value < 0) {
+                arg.negative = true;
+                arg.magnitude = static_cast<unsigned_type>(
+                    0u - static_cast<unsigned_type>(value));
+            }
+        }
+    }
+    return arg;
+}
+
+class line_buffer {
+public:
+    void put(char c) {
+        if (m_size < capacity) {
+            m_data[m_size++] = c;
+        }
+    }
+
+    void put(std::string_view str) {
+        for (const auto c : str) {
+            put(c);
+        }
+    }
+
+    void pad(std::size_t count, char c) {
+        for (auto i = 0u; i < count; i++) {
+            put(c);
+        }
+    }
+
+    void flush() {
+        m_data[m_size++] = '\n';
+        std::fwrite(m_data, 1u, m_size, stdout);
+        m_size = 0u;
+    }
+
+private:
+    static constexpr std::size_t capacity = 255u;
+    char m_data[capacity + 1u];
+    std::size_t m_size{0};
+};
+
+inline void put_field(line_buffer& out, const spec_t& spec,
+                      std::string_view prefix, std::string_view body) {
+    const auto length = prefix.size() + body.size();
+    const auto fill = spec.width > length ? spec.width - length : 0u;
+    if (!spec.left && !spec.zero) {
+        out.pad(fill, ' ');
+    }
+    out.put(prefix);
+    if (!spec.left && spec.zero) {
+        out.pad(fill, '0');
+    }
+    out.put(body);
+    if (spec.left) {
+        out.pad(fill, ' ');
+    }
+}
+
+// Converts backwards into the end of the buffer and returns the first digit.
+// Values fitting into 32 bits avoid the slow 64-bit division helpers.
+template <typename T>
+auto to_digits(T value, unsigned base, const char* symbols, char* end)
+    -> char* {
+    do {
+        *--end = symbols[value % base];
+        value /= base;
+    } while (value);
+    return end;
+}
+
+inline void put_integer(line_buffer& out, const spec_t& spec,
+                        const arg_t& arg) {
+    const auto hex = spec.conversion == 'x' || spec.conversion == 'X';
+    const auto base = hex ? 16u : 10u;
+    const auto* symbols =
+        spec.conversion == 'X' ? "0123456789ABCDEF" : "0123456789abcdef";
+    const auto value = spec.conversion == 'd' ? arg.magnitude : arg.bits;
+
+    char digits[24];
+    auto* const end = digits + sizeof(digits);
+    const auto* begin =
+        value <= 0xFFFFFFFFu
+            ? to_digits(static_cast<unsigned>(value), base, symbols, end)
+            : to_digits(value, base, symbols, end);
+
+    auto prefix = std::string_view{};
+    if (spec.conversion == 'd' && arg.negative) {
+        prefix = "-";
+    } else if (hex && spec.alt && value != 0u) {
+        prefix = spec.conversion == 'X' ? "0X" : "0x";
+    }
+    put_field(out, spec, prefix, {begin, end});
+}
+
+inline void put_arg(line_buffer& out, const spec_t& spec, const arg_t& arg) {
+    if (spec.conversion == 's') {
+        put_field(out, spec, {}, arg.str);
+    } else if (spec.conversion == 'c') {
+        const auto c = static_cast<char>(arg.bits);
+        put_field(out, spec, {}, {&c, 1u});
+    } else {
+        put_integer(out, spec, arg);
+    }
+}
+
+inline void format(line_buffer& out, std::string_view fmt,
+                   const arg_t* args) {
+    for (auto pos = std::size_t{0}; pos < fmt.size();) {
+        const auto c = fmt[pos++];
+        if (c != '%') {
+            out.put(c);
+        } else if (pos < fmt.size() && fmt[pos] == '%') {
+            out.put(fmt[pos++]);
+        } else {
+            put_arg(out, parse_spec(fmt, pos), *args++);
+        }
+    }
+}
+
+} // namespace log_internal
+
+template <typename... Args>
+void log(log_internal::format_string<std::type_identity_t<Args>...> fmt,
+         const Args&... args) {
+    const log_internal::arg_t list[] = {log_internal::make_arg(args)..., {}};
+    auto out = log_internal::line_buffer{};
+    log_internal::format(out, fmt.get(), list);
+    out.flush();
+}
@@ -0,0 +1,289 @@
+// Necrowares's Video Memory Tester
+// Copyright (C) 2025 by Necroware
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "copy.hpp"
+
+#include <cpuid.h>
+#include <go32.h>
+#include <sys/movedata.h>
+#include <time.h>
+
+#include <array>
+#include <limits>
+#include <vector>
+
+namespace vbe::copy {
+
+namespace internal {
+
+// Plain string operations, ES or FS is loaded with the far selector for the
+// duration of the transfer and restored afterwards.
+
+void movsb_write(int selector, std::uint32_t offset, const void* src,
+                 std::size_t count) {
+    asm volatile("pushl %%es\n\t"
+                 "movw %w3, %%es\n\t"
+                 "rep movsb\n\t"
+                 "popl %%es"
+                 : "+D"(offset), "+S"(src), "+c"(count)
+                 : "r"(selector)
+                 : "memory");
+}
+
+void movsd_write(int selector, std::uint32_t offset, const void* src,
+                 std::size_t count) {
+    asm volatile("pushl %%es\n\t"
+                 "movw %w3, %%es\n\t"
+                 "rep movsl\n\t"
+                 "popl %%es"
+                 : "+D"(offset), "+S"(src), "+c"(count)
+                 : "r"(selector)
+                 : "memory");
+}
+
+void movsb_read(void* dst, int selector, std::uint32_t offset,
+                std::size_t count) {
+    asm volatile("pushl %%fs\n\t"
+                 "movw %w3, %%fs\n\t"
+                 "rep movsb %%fs:(%%esi), %%es:(%%edi)\n\t"
+                 "popl %%fs"
+                 : "+D"(dst), "+S"(offset), "+c"(count)
+                 : "r"(selector)
+                 : "memory");
+}
+
+void movsd_read(void* dst, int selector, std::uint32_t offset,
+                std::size_t count) {
+    asm volatile("pushl %%fs\n\t"
+                 "movw %w3, %%fs\n\t"
+                 "rep movsl %%fs:(%%esi), %%es:(%%edi)\n\t"
+                 "popl %%fs"
+                 : "+D"(dst), "+S"(offset), "+c"(count)
+                 : "r"(selector)
+                 : "memory");
+}
+
+// MMX transfers move 32 bytes per iteration, the count is given in such
+// blocks. The non-temporal variant needs either SSE or AMD's MMX extensions
+// and only uses MMX registers, so it doesn't depend on the OS enabling SSE
+// state saving, which no DOS extender does.
+
+__attribute__((target("mmx"))) void
+mmx_write(int selector, std::uint32_t offset, const void* src,
+          std::size_t count) {
+    asm volatile("pushl %%fs\n\t"
+                 "movw %w3, %%fs\n"
+                 "1:\n\t"
+                 "movq (%%esi), %%mm0\n\t"
+                 "movq 8(%%esi), %%mm1\n\t"
+                 "movq 16(%%esi), %%mm2\n\t"
+                 "movq 24(%%esi), %%mm3\n\t"
+                 "movq %%mm0, %%fs:(%%edi)\n\t"
+                 "movq %%mm1, %%fs:8(%%edi)\n\t"
+                 "movq %%mm2, %%fs:16(%%edi)\n\t"
+                 "movq %%mm3, %%fs:24(%%edi)\n\t"
+                 "addl $32, %%esi\n\t"
+                 "addl $32, %%edi\n\t"
+                 "decl %%ecx\n\t"
+                 "jnz 1b\n\t"
+                 "emms\n\t"
+                 "popl %%fs"
+                 : "+D"(offset), "+S"(src), "+c"(count)
+                 : "r"(selector)
+                 : "memory", "cc", "mm0", "mm1", "mm2", "mm3");
+}
+
+__attribute__((target("mmx"))) void
+mmx_read(void* dst, int selector, std::uint32_t offset, std::size_t count) {
+    asm volatile("pushl %%fs\n\t"
+                 "movw %w3, %%fs\n"
+                 "1:\n\t"
+                 "movq %%fs:(%%esi), %%mm0\n\t"
+                 "movq %%fs:8(%%esi), %%mm1\n\t"
+                 "movq %%fs:16(%%esi), %%mm2\n\t"
+                 "movq %%fs:24(%%esi), %%mm3\n\t"
+                 "movq %%mm0, (%%edi)\n\t"
+                 "movq %%mm1, 8(%%edi)\n\t"
+                 "movq %%mm2, 16(%%edi)\n\t"
+                 "movq %%mm3, 24(%%edi)\n\t"
+                 "addl $32, %%esi\n\t"
+                 "addl $32, %%edi\n\t"
+                 "decl %%ecx\n\t"
+                 "jnz 1b\n\t"
+                 "emms\n\t"
+                 "popl %%fs"
+                 : "+D"(dst), "+S"(offset), "+c"(count)
+                 : "r"(selector)
+                 : "memory", "cc", "mm0", "mm1", "mm2", "mm3");
+}
+
+__attribute__((target("mmx"))) void
+movntq_write(int selector, std::uint32_t offset, const void* src,
+             std::size_t count) {
+    asm volatile("pushl %%fs\n\t"
+                 "movw %w3, %%fs\n"
+                 "1:\n\t"
+                 "movq (%%esi), %%mm0\n\t"
+                 "movq 8(%%esi), %%mm1\n\t"
+                 "movq 16(%%esi), %%mm2\n\t"
+                 "movq 24(%%esi), %%mm3\n\t"
+                 "movntq %%mm0, %%fs:(%%edi)\n\t"
+                 "movntq %%mm1, %%fs:8(%%edi)\n\t"
+                 "movntq %%mm2, %%fs:16(%%edi)\n\t"
+                 "movntq %%mm3, %%fs:24(%%edi)\n\t"
+                 "addl $32, %%esi\n\t"
+                 "addl $32, %%edi\n\t"
+                 "decl %%ecx\n\t"
+                 "jnz 1b\n\t"
+                 "sfence\n\t"
+                 "emms\n\t"
+                 "popl %%fs"
+                 : "+D"(offset), "+S"(src), "+c"(count)
+                 : "r"(selector)
+                 : "memory", "cc", "mm0", "mm1", "mm2", "mm3");
+}
+
+auto has_cpuid_bit(unsigned leaf, unsigned edx_bit) -> bool {
+    unsigned eax{}, ebx{}, ecx{}, edx{};
+    return __get_cpuid(leaf, &eax, &ebx, &ecx, &edx) && (edx & edx_bit);
+}
+
+auto always() -> bool { return true; }
+auto has_mmx() -> bool { return has_cpuid_bit(1u, bit_MMX); }
+auto has_movntq() -> bool {
+    return has_mmx() && (has_cpuid_bit(1u, bit_SSE) ||
+                         has_cpuid_bit(0x80000001u, bit_MMXEXT));
+}
+
+// Engines
+
+void movedata_write(int selector, std::uint32_t offset, const void* src,
+                    std::size_t size) {
+    const auto src_offset = reinterpret_cast<unsigned>(src);
+    movedata(_my_ds(), src_offset, selector, offset, size);
+}
+
+void movedata_read(void* dst, int selector, std::uint32_t offset,
+                   std::size_t size) {
+    const auto dst_offset = reinterpret_cast<unsigned>(dst);
+    movedata(selector, offset, _my_ds(), dst_offset, size);
+}
+
+void dword_write(int selector, std::uint32_t offset, const void* src,
+                 std::size_t size) {
+    const auto* bytes = static_cast<const std::uint8_t*>(src);
+    split(
+        offset, size, 4u, 4u,
+        [&](auto pos, auto len) {
+            movsd_write(selector, offset + pos, bytes + pos, len / 4u);
+        },
+        [&](auto pos, auto len) {
+            movsb_write(selector, offset + pos, bytes + pos, len);
+        });
+}
+
+void dword_read(void* dst, int selector, std::uint32_t offset,
+                std::size_t size) {
+    auto* bytes = static_cast<std::uint8_t*>(dst);
+    split(
+        offset, size, 4u, 4u,
+        [&](auto pos, auto len) {
+            movsd_read(bytes + pos, selector, offset + pos, len / 4u);
+        },
+        [&](auto pos, auto len) {
+            movsb_read(bytes + pos, selector, offset + pos, len);
+        });
+}
+
+template <auto Bulk>
+void qword_write(int selector, std::uint32_t offset, const void* src,
+                 std::size_t size) {
+    const auto* bytes = static_cast<const std::uint8_t*>(src);
+    split(
+        offset, size, 8u, 32u,
+        [&](auto pos, auto len) {
+            Bulk(selector, offset + pos, bytes + pos, len / 32u);
+        },
+        [&](auto pos, auto len) {
+            dword_write(selector, offset + pos, bytes + pos, len);
+        });
+}
+
+void qword_read(void* dst, int selector, std::uint32_t offset,
+                std::size_t size) {
+    auto* bytes = static_cast<std::uint8_t*>(dst);
+    split(
+        offset, size, 8u, 32u,
+        [&](auto pos, auto len) {
+            mmx_read(bytes + pos, selector, offset + pos, len / 32u);
+        },
+        [&](auto pos, auto len) {
+            dword_read(bytes + pos, selector, offset + pos, len);
+        });
+}
+
+// There are no non-temporal loads without SSE4.1, so the streaming engine
+// reads like the MMX one.
+constexpr auto all_engines = std::array{
+    engine{"movedata", always, movedata_write, movedata_read},
+    engine{"movsd", always, dword_write, dword_read},
+    engine{"mmx", has_mmx, qword_write<mmx_write>, qword_read},
+    engine{"movntq", has_movntq, qword_write<movntq_write>, qword_read},
+};
+
+template <typename Func>
+auto measure(Func&& func) -> uclock_t {
+    constexpr auto repeats = 4u;
+    const auto start = uclock();
+    for (auto i = 0u; i < repeats; i++) {
+        func();
+    }
+    return uclock() - start;
+}
+
+} // namespace internal
+
+auto engines() -> std::span<const engine> { return internal::all_engines; }
+
+auto select_fastest(int selector, std::uint32_t offset, std::size_t size)
+    -> selection {
+    auto buffer = std::vector<std::uint8_t>(size, 0u);
+    auto result = selection{&engines().front(), &engines().front()};
+    auto best_write = std::numeric_limits<uclock_t>::max();
+    auto best_read = std::numeric_limits<uclock_t>::max();
+    for (const auto& candidate : engines()) {
+        if (!candidate.supported()) {
+            continue;
+        }
+        const auto write_time = internal::measure([&] {
+            candidate.write(selector, offset, buffer.data(), size);
+        });
+        if (write_time < best_write) {
+            best_write = write_time;
+            result.write = &candidate;
+        }
+        const auto read_time = internal::measure([&] {
+            candidate.read(buffer.data(), selector, offset, size);
+        });
+        if (read_time < best_read) {
+            best_read = read_time;
+            result.read = &candidate;
+        }
+    }
+    return result;
+}
+
+} // namespace vbe::copy
@@ -0,0 +1,75 @@
+// Necrowares's Video Memory Tester
+// Copyright (C) 2025 by Necroware
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace vbe::copy {
+
+// A copy engine moves data between the conventional memory of the program
+// and a far memory region addressed by a selector, e.g. the linear frame
+// buffer. Different CPUs and cards prefer different instructions, so there
+// are several implementations and the fastest supported one gets picked at
+// runtime.
+struct engine {
+    const char* name;
+    bool (*supported)();
+    void (*write)(int selector, std::uint32_t offset, const void* src,
+                  std::size_t size);
+    void (*read)(void* dst, int selector, std::uint32_t offset,
+                 std::size_t size);
+};
+
+// Splits a transfer into an unaligned head, a bulk part which starts at an
+// offset aligned to `align` and has a size multiple of `granule`, and a tail.
+// The callbacks get the position relative to the start of the transfer and
+// the length of the part. Empty parts are skipped.
+template <typename Bulk, typename Bytes>
+void split(std::uint32_t offset, std::size_t size, std::size_t align,
+           std::size_t granule, Bulk bulk, Bytes bytes) {
+    auto head = (align - offset % align) % align;
+    if (head > size) {
+        head = size;
+    }
+    const auto body = (size - head) / granule * granule;
+    const auto tail = size - head - body;
+    if (head) {
+        bytes(0u, head);
+    }
+    if (body) {
+        bulk(head, body);
+    }
+    if (tail) {
+        bytes(head + body, tail);
+    }
+}
+
+// All known engines, baseline first
+auto engines() -> std::span<const engine>;
+
+// Benchmarks all supported engines on the given far memory region and returns
+// the fastest one for writing and the fastest one for reading.
+struct selection {
+    const engine* write;
+    const engine* read;
+};
+auto select_fastest(int selector, std::uint32_t offset, std::size_t size)
+    -> selection;
+
+} // namespace vbe::copy
@@ -16,11 +16,14 @@
 
 #include "vbe.hpp"
 
+#include "copy.hpp"
+
 #include <dpmi.h>
 #include <dpmi.hpp>
 #include <go32.h>
 #include <sys/farptr.h>
 
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 
@@ -188,13 +191,45 @@ class framebuffer::impl {
 public:
     explicit impl(const internal::mode_info_t& mode_info)
     : m_mode_info{mode_info},
-      m_mapping{m_mode_info.phys_base_ptr, get_total_memory_size()} {}
+      m_mapping{m_mode_info.phys_base_ptr, get_total_memory_size()},
+      m_engines{select_engines(m_mapping)} {}
+
+    [[nodiscard]] auto write_engine() const -> const copy::engine& {
+        return *m_engines.write;
+    }
+    [[nodiscard]] auto read_engine() const -> const copy::engine& {
+        return *m_engines.read;
+    }
+
+    void write(std::uint32_t offset, const void* data, std::size_t size) {
+        const auto* bytes = static_cast<const std::uint8_t*>(data);
+        m_mapping.for_each_chunk(offset, size, [&](const auto& chunk,
+                                                   auto pos) {
+            m_engines.write->write(chunk.selector, chunk.offset, bytes + pos,
+                                   chunk.size);
+        });
+    }
 
-    [[nodiscard]] auto selector() const { return m_mapping.selector(); }
+    void read(std::uint32_t offset, void* data, std::size_t size) {
+        auto* bytes = static_cast<std::uint8_t*>(data);
+        m_mapping.for_each_chunk(offset, size, [&](const auto& chunk,
+                                                   auto pos) {
+            m_engines.read->read(bytes + pos, chunk.selector, chunk.offset,
+                                 chunk.size);
+        });
+    }
 
 private:
     internal::mode_info_t m_mode_info;
-    dpmi::physical_memory_mapping m_mapping;
+    dpmi::windowed_mapping m_mapping;
+    copy::selection m_engines;
+
+    static auto select_engines(dpmi::windowed_mapping& mapping)
+        -> copy::selection {
+        const auto view = mapping.map(0u);
+        const auto size = std::min<std::size_t>(view.size, 256u * 1024u);
+        return copy::select_fastest(view.selector, view.offset, size);
+    }
 };
 
 framebuffer::framebuffer(std::uint16_t mode_id) {
@@ -207,18 +242,22 @@ framebuffer::~framebuffer() { internal::reset_mode(); }
 framebuffer::framebuffer(framebuffer&&) noexcept = default;
 framebuffer& framebuffer::operator=(framebuffer&&) noexcept = default;
 
-auto framebuffer::selector() const -> int { return m_pimpl->selector(); }
+auto framebuffer::write_engine() const -> const char* {
+    return m_pimpl->write_engine().name;
+}
+
+auto framebuffer::read_engine() const -> const char* {
+    return m_pimpl->read_engine().name;
+}
 
 void framebuffer::write(std::uint32_t offset, const void* data,
                         std::size_t size) const {
-    const auto src_offset = reinterpret_cast<const unsigned>(data);
-    movedata(_my_ds(), src_offset, selector(), offset, size);
+    m_pimpl->write(offset, data, size);
 }
 
 void framebuffer::read(std::uint32_t offset, void* data,
                        std::size_t size) const {
-    const auto dst_offset = reinterpret_cast<const unsigned>(data);
-    movedata(selector(), offset, _my_ds(), dst_offset, size);
+    m_pimpl->read(offset, data, size);
 }
 
 } // namespace vbe
@@ -47,7 +47,8 @@ public:
     framebuffer& operator=(const framebuffer&) = delete;
     framebuffer& operator=(framebuffer&&) noexcept;
 
-    [[nodiscard]] auto selector() const -> int; 
+    [[nodiscard]] auto write_engine() const -> const char*;
+    [[nodiscard]] auto read_engine() const -> const char*;
     void write(std::uint32_t offset, const void* data, std::size_t size) const;
     void read(std::uint32_t offset, void* data, std::size_t size) const;
 